@@ -21,7 +21,11 @@ void BindAABBTreeBuilder(nb::module_ &m) {
         .def(nb::init<TriangleSplitter &, uint>(), "in_splitter"_a, "max_triangles_per_leaf"_a = 16, "Constructor")
         .def("build", [](AABBTreeBuilder &self) {
             AABBTreeBuilderStats outStats;
-            auto r = self.Build(outStats);
+            AABBTreeBuilder::Node *r;
+            {
+                nb::gil_scoped_release release;
+                r = self.Build(outStats);
+            }
             return nb::make_tuple(r, outStats);
         }, "Recursively build tree, returns the root node of the tree\n"
            "Output: [root*, TreeBuilderStats]");
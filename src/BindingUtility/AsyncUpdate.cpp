@@ -0,0 +1,90 @@
+#include "Common.h"
+#include "BindingUtility/AsyncUpdate.h"
+#include "BindingUtility/NumpyRows.h"
+#include <cstring>
+
+/// Copy of a snapshot buffer, a view would dangle when a later capture reallocates the buffer
+template <class T>
+static nb::ndarray<nb::numpy, T> sCopyArray(const Array<T> &inData, std::initializer_list<size_t> inShape) {
+    nb::ndarray<nb::numpy, T> array = AllocateNumpyArray<T>(inShape);
+    memcpy(array.data(), inData.data(), inData.size() * sizeof(T));
+    return array;
+}
+
+// Completes inFuture with inErrors on its loop, the future may have been cancelled in the meantime
+static void sSetFutureResult(nb::handle inFuture, EPhysicsUpdateError inErrors) {
+    if (!nb::cast<bool>(inFuture.attr("done")()))
+        inFuture.attr("set_result")(inErrors);
+}
+
+nb::object PhysicsUpdateHandle::CreateFuture() {
+    nb::object loop = nb::module_::import_("asyncio").attr("get_running_loop")();
+    nb::object future = loop.attr("create_future")();
+    {
+        // The update thread takes this lock without the GIL, so it can't deadlock with us
+        std::lock_guard lock(mWaitersMutex);
+        if (!IsDone()) {
+            mWaiters.push_back({ loop, future });
+            return future;
+        }
+    }
+    future.attr("set_result")(mErrors);
+    return future;
+}
+
+void PhysicsUpdateHandle::NotifyDone() {
+    Array<Waiter> waiters;
+    {
+        std::lock_guard lock(mWaitersMutex);
+        mDone.store(true, std::memory_order_release);
+        waiters.swap(mWaiters);
+    }
+    if (waiters.empty())
+        return;
+
+    nb::gil_scoped_acquire gil;
+    nb::object set_result = nb::cpp_function(&sSetFutureResult);
+    for (const Waiter &waiter : waiters) {
+        try {
+            waiter.mLoop.attr("call_soon_threadsafe")(set_result, waiter.mFuture, mErrors);
+        } catch (const nb::python_error &) {
+            // The loop was closed, nobody is waiting for the result anymore
+        }
+    }
+    waiters.clear();
+}
+
+void BindAsyncUpdate(nb::module_ &m) {
+    nb::class_<TransformSnapshot>(m, "TransformSnapshot",
+        "Double buffered copy of the body transforms, filled by PhysicsSystem.update_async before the step starts.\n"
+        "The front buffer can be read while the next step simulates, the getters return copies that stay valid.")
+        .def(nb::init<PhysicsSystem &, bool>(), "physics_system"_a, "active_only"_a = false, nb::keep_alive<1, 2>())
+        .def("capture", &TransformSnapshot::Capture, nb::call_guard<nb::gil_scoped_release>(),
+            "Copy the current transforms, update_async does this automatically. The system must not be simulating.")
+        .def("get_step", [](const TransformSnapshot &self) { return self.GetFront().mStep; },
+            "Number of captures so far, identifies the data in the front buffer")
+        .def("get_body_ids", [](const TransformSnapshot &self) {
+            const TransformSnapshot::Buffer &front = self.GetFront();
+            return sCopyArray(front.mIDs, { front.mIDs.size() });
+        }, "(N,) uint32 array with the IDs of the captured bodies")
+        .def("get_positions", [](const TransformSnapshot &self) {
+            const TransformSnapshot::Buffer &front = self.GetFront();
+            return sCopyArray(front.mPositions, { front.mIDs.size(), 3 });
+        }, "(N, 3) array with the positions of the captured bodies")
+        .def("get_rotations", [](const TransformSnapshot &self) {
+            const TransformSnapshot::Buffer &front = self.GetFront();
+            return sCopyArray(front.mRotations, { front.mIDs.size(), 4 });
+        }, "(N, 4) float32 array with the rotations (x, y, z, w) of the captured bodies");
+
+    nb::class_<PhysicsUpdateHandle>(m, "PhysicsUpdateHandle",
+        "Handle to a PhysicsSystem.update_async call. The physics system must not be used until the update is done.\n"
+        "Can be awaited from asyncio, the result is the EPhysicsUpdateError of the update.")
+        .def("done", &PhysicsUpdateHandle::IsDone,
+            "Check if the update has finished")
+        .def("wait", &PhysicsUpdateHandle::Wait, nb::call_guard<nb::gil_scoped_release>(),
+            "Block until the update has finished, returns the errors of the update")
+        .def("__await__", [](PhysicsUpdateHandle &self) {
+            // The update thread completes the future, no executor thread is blocked while waiting
+            return self.CreateFuture().attr("__await__")();
+        });
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include "Common.h"
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Core/JobSystem.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+/// Double buffered copy of the body transforms. Capture() fills the back buffer and swaps it to the front,
+/// so the front buffer can be read while the next capture is being filled. Capturing can reallocate the buffers, hand out copies only.
+class TransformSnapshot {
+  public:
+    struct Buffer {
+        Array<uint32> mIDs;
+        Array<Real> mPositions;
+        Array<float> mRotations;
+        uint64 mStep = 0;
+    };
+
+    TransformSnapshot(PhysicsSystem &inSystem, bool inActiveOnly) :
+        mSystem(inSystem),
+        mActiveOnly(inActiveOnly) {
+    }
+
+    /// Copy the transforms of the bodies, the system must not be simulating or modified while capturing
+    void Capture() {
+        Buffer &back = mBuffers[mFront ^ 1];
+
+        if (mActiveOnly) {
+            uint32 num_active = mSystem.GetNumActiveBodies(EBodyType::RigidBody);
+            const BodyID *active = mSystem.GetActiveBodiesUnsafe(EBodyType::RigidBody);
+            mBodyIDs.assign(active, active + num_active);
+        } else
+            mSystem.GetBodies(mBodyIDs);
+
+        back.mIDs.clear();
+        back.mPositions.clear();
+        back.mRotations.clear();
+        back.mIDs.reserve(mBodyIDs.size());
+        back.mPositions.reserve(3 * mBodyIDs.size());
+        back.mRotations.reserve(4 * mBodyIDs.size());
+
+        const BodyLockInterfaceNoLock &lock_interface = mSystem.GetBodyLockInterfaceNoLock();
+        for (const BodyID &id : mBodyIDs) {
+            const Body *body = lock_interface.TryGetBody(id);
+            if (body == nullptr)
+                continue;
+
+            RVec3 position = body->GetPosition();
+            Quat rotation = body->GetRotation();
+            back.mIDs.push_back(id.GetIndexAndSequenceNumber());
+            back.mPositions.push_back(position.GetX());
+            back.mPositions.push_back(position.GetY());
+            back.mPositions.push_back(position.GetZ());
+            back.mRotations.push_back(rotation.GetX());
+            back.mRotations.push_back(rotation.GetY());
+            back.mRotations.push_back(rotation.GetZ());
+            back.mRotations.push_back(rotation.GetW());
+        }
+
+        back.mStep = ++mNumCaptures;
+        mFront ^= 1;
+    }
+
+    inline const Buffer &GetFront() const {
+        return mBuffers[mFront];
+    }
+
+    inline const PhysicsSystem &GetSystem() const {
+        return mSystem;
+    }
+
+  private:
+    PhysicsSystem &mSystem;
+    bool mActiveOnly;
+    uint mFront = 0;
+    uint64 mNumCaptures = 0;
+    Buffer mBuffers[2];
+    BodyIDVector mBodyIDs;
+};
+
+/// PhysicsSystem::Update running on its own thread, the physics system must not be touched until the update is done
+class PhysicsUpdateHandle {
+  public:
+    PhysicsUpdateHandle(PhysicsSystem &inSystem, float inDeltaTime, int inCollisionSteps, TempAllocator *inTempAllocator, JobSystem *inJobSystem) {
+        mThread = std::thread([this, &inSystem, inDeltaTime, inCollisionSteps, inTempAllocator, inJobSystem]() {
+            mErrors = inSystem.Update(inDeltaTime, inCollisionSteps, inTempAllocator, inJobSystem);
+            NotifyDone();
+        });
+    }
+
+    ~PhysicsUpdateHandle() {
+        // The update can call into Python listeners, so don't hold the GIL while waiting for it
+        if (PyGILState_Check()) {
+            nb::gil_scoped_release release;
+            Join();
+        } else
+            Join();
+    }
+
+    inline bool IsDone() const {
+        return mDone.load(std::memory_order_acquire);
+    }
+
+    /// Wait for the update to finish and return its errors, call without holding the GIL
+    EPhysicsUpdateError Wait() {
+        Join();
+        return mErrors;
+    }
+
+    /// Create an asyncio future on the running loop that the update thread completes with the errors of the update, requires the GIL
+    nb::object CreateFuture();
+
+  private:
+    struct Waiter {
+        nb::object mLoop;
+        nb::object mFuture;
+    };
+
+    /// Mark the update as done and complete the futures through call_soon_threadsafe, called on the update thread
+    void NotifyDone();
+
+    void Join() {
+        std::lock_guard lock(mJoinMutex);
+        if (mThread.joinable())
+            mThread.join();
+    }
+
+    std::thread mThread;
+    std::mutex mJoinMutex;
+    std::mutex mWaitersMutex;
+    Array<Waiter> mWaiters;
+    std::atomic<bool> mDone = false;
+    EPhysicsUpdateError mErrors = EPhysicsUpdateError::None;
+};
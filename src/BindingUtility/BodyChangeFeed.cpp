@@ -0,0 +1,159 @@
+#include "Common.h"
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/Body/BodyLockMulti.h>
+#include <nanobind/ndarray.h>
+
+/// Collects the bodies that moved, woke up or fell asleep since the previous capture.
+/// Only the active bodies (and the bodies that were active during the previous capture) are visited,
+/// so the cost scales with the number of active bodies instead of the total number of bodies.
+class BodyChangeFeed {
+  public:
+    BodyChangeFeed(PhysicsSystem &inSystem, EBodyType inBodyType) :
+        mSystem(inSystem),
+        mBodyType(inBodyType),
+        mSlots(inSystem.GetMaxBodies()) {
+        // Every body is reported at most once per list, so with this capacity the buffers never reallocate and views on them stay valid
+        uint max_bodies = inSystem.GetMaxBodies();
+        mMovedIDs.reserve(max_bodies);
+        mPositions.reserve(3 * max_bodies);
+        mRotations.reserve(4 * max_bodies);
+        mActivatedIDs.reserve(max_bodies);
+        mDeactivatedIDs.reserve(max_bodies);
+    }
+
+    /// Call after PhysicsSystem::Update, not while the simulation is running
+    void Capture() {
+        ++mCapture;
+
+        mMovedIDs.clear();
+        mPositions.clear();
+        mRotations.clear();
+        mActivatedIDs.clear();
+        mDeactivatedIDs.clear();
+
+        // Detect bodies that became active
+        uint32 num_active = mSystem.GetNumActiveBodies(mBodyType);
+        const BodyID *active = mSystem.GetActiveBodiesUnsafe(mBodyType);
+        mCurrent.assign(active, active + num_active);
+        for (const BodyID &id : mCurrent) {
+            Slot &slot = GetSlot(id);
+            if (slot.mActiveID != id.GetIndexAndSequenceNumber() || slot.mActiveCapture != mCapture - 1)
+                mActivatedIDs.push_back(id.GetIndexAndSequenceNumber());
+            slot.mActiveID = id.GetIndexAndSequenceNumber();
+            slot.mActiveCapture = mCapture;
+        }
+
+        // Bodies that were active last time but aren't anymore went to sleep (or were removed)
+        mCandidates = mCurrent;
+        for (const BodyID &id : mPrevious) {
+            Slot &slot = GetSlot(id);
+            if (slot.mActiveID == id.GetIndexAndSequenceNumber() && slot.mActiveCapture != mCapture) {
+                mDeactivatedIDs.push_back(id.GetIndexAndSequenceNumber());
+                mCandidates.push_back(id);
+            }
+        }
+        mPrevious.swap(mCurrent);
+
+        // Compare the transforms of all candidates with the last exported transform
+        if (mCandidates.empty())
+            return;
+        BodyLockMultiRead lock(mSystem.GetBodyLockInterface(), mCandidates.data(), (int)mCandidates.size());
+        for (int i = 0; i < (int)mCandidates.size(); ++i) {
+            const Body *body = lock.GetBody(i);
+            if (body == nullptr)
+                continue;
+
+            Slot &slot = GetSlot(body->GetID());
+            RVec3 position = body->GetPosition();
+            Quat rotation = body->GetRotation();
+            if (slot.mTransformID == body->GetID().GetIndexAndSequenceNumber() && slot.mPosition == position && slot.mRotation == rotation)
+                continue;
+
+            slot.mTransformID = body->GetID().GetIndexAndSequenceNumber();
+            slot.mPosition = position;
+            slot.mRotation = rotation;
+
+            mMovedIDs.push_back(slot.mTransformID);
+            mPositions.push_back(position.GetX());
+            mPositions.push_back(position.GetY());
+            mPositions.push_back(position.GetZ());
+            mRotations.push_back(rotation.GetX());
+            mRotations.push_back(rotation.GetY());
+            mRotations.push_back(rotation.GetZ());
+            mRotations.push_back(rotation.GetW());
+        }
+    }
+
+    /// Forget all exported state, the next capture reports all active bodies as moved and activated
+    void Reset() {
+        mSlots.clear();
+        mSlots.resize(mSystem.GetMaxBodies());
+        mPrevious.clear();
+        mCapture = 0;
+    }
+
+    Array<uint32> mMovedIDs;
+    Array<Real> mPositions;
+    Array<float> mRotations;
+    Array<uint32> mActivatedIDs;
+    Array<uint32> mDeactivatedIDs;
+
+  private:
+    struct Slot {
+        uint32 mActiveID = BodyID::cInvalidBodyID;
+        uint32 mActiveCapture = 0;
+        uint32 mTransformID = BodyID::cInvalidBodyID;
+        RVec3 mPosition = RVec3::sZero();
+        Quat mRotation = Quat::sIdentity();
+    };
+
+    inline Slot &GetSlot(const BodyID &inID) {
+        return mSlots[inID.GetIndex()];
+    }
+
+    PhysicsSystem &mSystem;
+    EBodyType mBodyType;
+    uint32 mCapture = 0;
+    Array<Slot> mSlots;
+    Array<BodyID> mPrevious;
+    Array<BodyID> mCurrent;
+    Array<BodyID> mCandidates;
+};
+
+void BindBodyChangeFeed(nb::module_ &m) {
+    using NumpyIDs = nb::ndarray<nb::numpy, const uint32, nb::shape<-1>>;
+    using NumpyPositions = nb::ndarray<nb::numpy, const Real, nb::shape<-1, 3>>;
+    using NumpyRotations = nb::ndarray<nb::numpy, const float, nb::shape<-1, 4>>;
+
+    nb::class_<BodyChangeFeed>(m, "BodyChangeFeed",
+        "Change feed of the body state after PhysicsSystem.update.\n"
+        "capture() walks the active bodies and fills reusable buffers with the bodies whose transform changed since the previous capture\n"
+        "and with the bodies that woke up or fell asleep. The returned arrays are views on these buffers and are overwritten by the next capture,\n"
+        "the buffers are allocated for the max number of bodies up front so the views never dangle.\n"
+        "Bodies that are moved while asleep without being activated are not reported.")
+        .def(nb::init<PhysicsSystem &, EBodyType>(), "physics_system"_a, "body_type"_a = EBodyType::RigidBody, nb::keep_alive<1, 2>())
+        .def("capture", &BodyChangeFeed::Capture, nb::call_guard<nb::gil_scoped_release>(),
+            "Collect the changes since the previous capture, call after PhysicsSystem.update")
+        .def("reset", &BodyChangeFeed::Reset,
+            "Forget all exported state, the next capture reports all active bodies as moved and activated")
+        .def("get_moved_ids", [](BodyChangeFeed &self) {
+            return NumpyIDs(self.mMovedIDs.data(), { self.mMovedIDs.size() }, nb::handle());
+        }, nb::rv_policy::reference_internal,
+            "(N,) uint32 array with the IDs of the bodies whose position or rotation changed")
+        .def("get_positions", [](BodyChangeFeed &self) {
+            return NumpyPositions(self.mPositions.data(), { self.mMovedIDs.size(), 3 }, nb::handle());
+        }, nb::rv_policy::reference_internal,
+            "(N, 3) array with the new positions of the moved bodies")
+        .def("get_rotations", [](BodyChangeFeed &self) {
+            return NumpyRotations(self.mRotations.data(), { self.mMovedIDs.size(), 4 }, nb::handle());
+        }, nb::rv_policy::reference_internal,
+            "(N, 4) float32 array with the new rotations (x, y, z, w) of the moved bodies")
+        .def("get_activated_ids", [](BodyChangeFeed &self) {
+            return NumpyIDs(self.mActivatedIDs.data(), { self.mActivatedIDs.size() }, nb::handle());
+        }, nb::rv_policy::reference_internal,
+            "(N,) uint32 array with the IDs of the bodies that woke up")
+        .def("get_deactivated_ids", [](BodyChangeFeed &self) {
+            return NumpyIDs(self.mDeactivatedIDs.data(), { self.mDeactivatedIDs.size() }, nb::handle());
+        }, nb::rv_policy::reference_internal,
+            "(N,) uint32 array with the IDs of the bodies that fell asleep or were removed");
+}
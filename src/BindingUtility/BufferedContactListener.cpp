@@ -0,0 +1,349 @@
+#include "Common.h"
+#include <Jolt/Physics/Collision/ContactListener.h>
+#include <Jolt/Physics/Collision/CollideShape.h>
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Core/QuickSort.h>
+#include "BindingUtility/StructuredArray.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/// Contact event as it is stored by the BufferedContactListener and exported to NumPy
+struct ContactEvent {
+    static Array<RecordField> sGetFields() {
+        return { { "body_id1", "<u4", 1, offsetof(ContactEvent, mBodyID1) },
+                 { "body_id2", "<u4", 1, offsetof(ContactEvent, mBodyID2) },
+                 { "sub_shape_id1", "<u4", 1, offsetof(ContactEvent, mSubShapeID1) },
+                 { "sub_shape_id2", "<u4", 1, offsetof(ContactEvent, mSubShapeID2) },
+                 { "contact_point_on1", cRealFormat, 3, offsetof(ContactEvent, mContactPointOn1) },
+                 { "contact_point_on2", cRealFormat, 3, offsetof(ContactEvent, mContactPointOn2) },
+                 { "normal", "<f4", 3, offsetof(ContactEvent, mNormal) },
+                 { "penetration_depth", "<f4", 1, offsetof(ContactEvent, mPenetrationDepth) },
+                 { "first_point", "<u4", 1, offsetof(ContactEvent, mFirstPoint) },
+                 { "num_points", "<u4", 1, offsetof(ContactEvent, mNumPoints) },
+                 { "combined_friction", "<f4", 1, offsetof(ContactEvent, mCombinedFriction) },
+                 { "combined_restitution", "<f4", 1, offsetof(ContactEvent, mCombinedRestitution) } };
+    }
+
+    /// Order used by drain(sort=True), makes the output independent of the thread that detected the contact
+    inline bool operator < (const ContactEvent &inRHS) const {
+        if (mBodyID1 != inRHS.mBodyID1)
+            return mBodyID1 < inRHS.mBodyID1;
+        if (mBodyID2 != inRHS.mBodyID2)
+            return mBodyID2 < inRHS.mBodyID2;
+        if (mSubShapeID1 != inRHS.mSubShapeID1)
+            return mSubShapeID1 < inRHS.mSubShapeID1;
+        return mSubShapeID2 < inRHS.mSubShapeID2;
+    }
+
+    uint32 mBodyID1;
+    uint32 mBodyID2;
+    uint32 mSubShapeID1;
+    uint32 mSubShapeID2;
+    Real mContactPointOn1[3];
+    Real mContactPointOn2[3];
+    Float3 mNormal;
+    float mPenetrationDepth;
+    uint32 mFirstPoint;
+    uint32 mNumPoints;
+    float mCombinedFriction;
+    float mCombinedRestitution;
+};
+
+/// World space contact point of a manifold, the points of an event are mNumPoints consecutive entries starting at mFirstPoint
+struct ContactEventPoint {
+    static Array<RecordField> sGetFields() {
+        return { { "point_on1", cRealFormat, 3, offsetof(ContactEventPoint, mPointOn1) },
+                 { "point_on2", cRealFormat, 3, offsetof(ContactEventPoint, mPointOn2) } };
+    }
+
+    Real mPointOn1[3];
+    Real mPointOn2[3];
+};
+
+/// Events of one kind together with their contact points
+struct ContactEventList {
+    void Clear() {
+        mEvents.clear();
+        mPoints.clear();
+    }
+
+    /// Append the events of inOther, moving their points to the end of mPoints
+    void Append(const ContactEventList &inOther) {
+        uint32 first_point = (uint32)mPoints.size();
+        mPoints.insert(mPoints.end(), inOther.mPoints.begin(), inOther.mPoints.end());
+        for (const ContactEvent &event : inOther.mEvents) {
+            ContactEvent &appended = mEvents.emplace_back(event);
+            appended.mFirstPoint += first_point;
+        }
+    }
+
+    /// Sort the events and store their points in the same order
+    void Sort() {
+        QuickSort(mEvents.begin(), mEvents.end());
+        if (mPoints.empty())
+            return;
+        Array<ContactEventPoint> points;
+        points.reserve(mPoints.size());
+        for (ContactEvent &event : mEvents) {
+            uint32 first_point = (uint32)points.size();
+            points.insert(points.end(), mPoints.begin() + event.mFirstPoint, mPoints.begin() + event.mFirstPoint + event.mNumPoints);
+            event.mFirstPoint = first_point;
+        }
+        mPoints.swap(points);
+    }
+
+    Array<ContactEvent> mEvents;
+    Array<ContactEventPoint> mPoints;
+};
+
+/// Contact listener that stores the contact events in per thread buffers without calling into Python during the simulation.
+/// The events are drained as NumPy arrays after PhysicsSystem::Update. Optionally forwards a subset of the callbacks to another listener.
+class BufferedContactListener : public ContactListener {
+  public:
+    /// inMaxThreads buffers are allocated up front, 0 for one per hardware thread plus one for the thread that calls PhysicsSystem::Update
+    BufferedContactListener(bool inRecordAdded, bool inRecordPersisted, bool inRecordRemoved, uint inMaxThreads) :
+        mRecordAdded(inRecordAdded),
+        mRecordPersisted(inRecordPersisted),
+        mRecordRemoved(inRecordRemoved) {
+        uint num_buffers = inMaxThreads != 0 ? inMaxThreads : max(std::thread::hardware_concurrency(), 1u) + 1;
+        mBuffers.reserve(num_buffers);
+        for (uint i = 0; i < num_buffers; ++i)
+            mBuffers.push_back(std::make_unique<ThreadBuffer>());
+    }
+
+    void SetChainedListener(ContactListener *inListener, bool inValidate, bool inAdded, bool inPersisted, bool inRemoved) {
+        mChained = inListener;
+        mChainValidate = inValidate;
+        mChainAdded = inAdded;
+        mChainPersisted = inPersisted;
+        mChainRemoved = inRemoved;
+    }
+
+    virtual ValidateResult OnContactValidate(const Body &inBody1, const Body &inBody2, RVec3Arg inBaseOffset, const CollideShapeResult &inCollisionResult) override {
+        if (mChained != nullptr && mChainValidate)
+            return mChained->OnContactValidate(inBody1, inBody2, inBaseOffset, inCollisionResult);
+        return ValidateResult::AcceptAllContactsForThisBodyPair;
+    }
+
+    virtual void OnContactAdded(const Body &inBody1, const Body &inBody2, const ContactManifold &inManifold, ContactSettings &ioSettings) override {
+        if (mChained != nullptr && mChainAdded)
+            mChained->OnContactAdded(inBody1, inBody2, inManifold, ioSettings);
+        if (mRecordAdded)
+            Record(GetThreadBuffer().mAdded, inBody1, inBody2, inManifold, ioSettings);
+    }
+
+    virtual void OnContactPersisted(const Body &inBody1, const Body &inBody2, const ContactManifold &inManifold, ContactSettings &ioSettings) override {
+        if (mChained != nullptr && mChainPersisted)
+            mChained->OnContactPersisted(inBody1, inBody2, inManifold, ioSettings);
+        if (mRecordPersisted)
+            Record(GetThreadBuffer().mPersisted, inBody1, inBody2, inManifold, ioSettings);
+    }
+
+    virtual void OnContactRemoved(const SubShapeIDPair &inSubShapePair) override {
+        if (mChained != nullptr && mChainRemoved)
+            mChained->OnContactRemoved(inSubShapePair);
+        if (mRecordRemoved) {
+            ContactEvent &event = GetThreadBuffer().mRemoved.mEvents.emplace_back();
+            memset(&event, 0, sizeof(event));
+            event.mBodyID1 = inSubShapePair.GetBody1ID().GetIndexAndSequenceNumber();
+            event.mBodyID2 = inSubShapePair.GetBody2ID().GetIndexAndSequenceNumber();
+            event.mSubShapeID1 = inSubShapePair.GetSubShapeID1().GetValue();
+            event.mSubShapeID2 = inSubShapePair.GetSubShapeID2().GetValue();
+        }
+    }
+
+    /// Move the events of all threads into mAdded, mPersisted and mRemoved, call when the simulation is not running
+    void Gather(bool inSort) {
+        mAdded.Clear();
+        mPersisted.Clear();
+        mRemoved.Clear();
+        ForEachBuffer([this](ThreadBuffer &ioBuffer) {
+            mAdded.Append(ioBuffer.mAdded);
+            mPersisted.Append(ioBuffer.mPersisted);
+            mRemoved.Append(ioBuffer.mRemoved);
+            ioBuffer.Clear();
+        });
+        if (inSort) {
+            mAdded.Sort();
+            mPersisted.Sort();
+            mRemoved.Sort();
+        }
+    }
+
+    /// Drop all buffered events
+    void Clear() {
+        ForEachBuffer([](ThreadBuffer &ioBuffer) {
+            ioBuffer.Clear();
+        });
+    }
+
+    ContactEventList mAdded;
+    ContactEventList mPersisted;
+    ContactEventList mRemoved;
+
+  private:
+    struct ThreadBuffer {
+        void Clear() {
+            mAdded.Clear();
+            mPersisted.Clear();
+            mRemoved.Clear();
+        }
+
+        std::atomic<std::thread::id> mThread { std::thread::id() }; ///< Only written by the thread that claimed the buffer
+        ContactEventList mAdded;
+        ContactEventList mPersisted;
+        ContactEventList mRemoved;
+    };
+
+    /// Find the buffer of the calling thread, the lookup is cached per thread.
+    /// The buffers that were allocated up front are claimed with an atomic counter, so the callbacks never lock.
+    /// Only threads beyond the number of preallocated buffers take the mutex, once on their first event.
+    ThreadBuffer &GetThreadBuffer() {
+        struct Cache {
+            uint64 mListenerID = 0;
+            ThreadBuffer *mBuffer = nullptr;
+        };
+        static thread_local Cache tCache;
+        if (tCache.mListenerID != mID) {
+            tCache.mListenerID = mID;
+            tCache.mBuffer = FindOrClaimBuffer();
+        }
+        return *tCache.mBuffer;
+    }
+
+    ThreadBuffer *FindOrClaimBuffer() {
+        std::thread::id thread = std::this_thread::get_id();
+
+        // The thread may already own a buffer when the cache was used by another listener in between
+        uint num_claimed = min(mNumClaimed.load(std::memory_order_acquire), (uint)mBuffers.size());
+        for (uint i = 0; i < num_claimed; ++i)
+            if (mBuffers[i]->mThread.load(std::memory_order_relaxed) == thread)
+                return mBuffers[i].get();
+
+        uint index = mNumClaimed.fetch_add(1, std::memory_order_acq_rel);
+        if (index < mBuffers.size()) {
+            mBuffers[index]->mThread.store(thread, std::memory_order_relaxed);
+            return mBuffers[index].get();
+        }
+
+        std::lock_guard lock(mOverflowMutex);
+        for (std::unique_ptr<ThreadBuffer> &b : mOverflow)
+            if (b->mThread.load(std::memory_order_relaxed) == thread)
+                return b.get();
+        ThreadBuffer *buffer = mOverflow.emplace_back(std::make_unique<ThreadBuffer>()).get();
+        buffer->mThread.store(thread, std::memory_order_relaxed);
+        return buffer;
+    }
+
+    /// Visit the buffers of all threads, call when the simulation is not running
+    template <class F>
+    void ForEachBuffer(const F &inFunction) {
+        uint num_claimed = min(mNumClaimed.load(std::memory_order_acquire), (uint)mBuffers.size());
+        for (uint i = 0; i < num_claimed; ++i)
+            inFunction(*mBuffers[i]);
+        std::lock_guard lock(mOverflowMutex);
+        for (std::unique_ptr<ThreadBuffer> &buffer : mOverflow)
+            inFunction(*buffer);
+    }
+
+    static void Record(ContactEventList &ioEvents, const Body &inBody1, const Body &inBody2, const ContactManifold &inManifold, const ContactSettings &inSettings) {
+        ContactEvent &event = ioEvents.mEvents.emplace_back();
+        event.mBodyID1 = inBody1.GetID().GetIndexAndSequenceNumber();
+        event.mBodyID2 = inBody2.GetID().GetIndexAndSequenceNumber();
+        event.mSubShapeID1 = inManifold.mSubShapeID1.GetValue();
+        event.mSubShapeID2 = inManifold.mSubShapeID2.GetValue();
+        inManifold.mWorldSpaceNormal.StoreFloat3(&event.mNormal);
+        event.mPenetrationDepth = inManifold.mPenetrationDepth;
+        event.mCombinedFriction = inSettings.mCombinedFriction;
+        event.mCombinedRestitution = inSettings.mCombinedRestitution;
+
+        // Store all contact points and report their center in the event
+        uint num_points = (uint)inManifold.mRelativeContactPointsOn1.size();
+        event.mFirstPoint = (uint32)ioEvents.mPoints.size();
+        Vec3 sum1 = Vec3::sZero(), sum2 = Vec3::sZero();
+        for (uint i = 0; i < num_points; ++i) {
+            sum1 += inManifold.mRelativeContactPointsOn1[i];
+            sum2 += inManifold.mRelativeContactPointsOn2[i];
+
+            ContactEventPoint &point = ioEvents.mPoints.emplace_back();
+            RVec3 on1 = inManifold.GetWorldSpaceContactPointOn1(i);
+            RVec3 on2 = inManifold.GetWorldSpaceContactPointOn2(i);
+            for (int c = 0; c < 3; ++c) {
+                point.mPointOn1[c] = on1[c];
+                point.mPointOn2[c] = on2[c];
+            }
+        }
+        float scale = num_points > 0 ? 1.0f / num_points : 0.0f;
+        RVec3 point1 = inManifold.mBaseOffset + scale * sum1;
+        RVec3 point2 = inManifold.mBaseOffset + scale * sum2;
+        for (int c = 0; c < 3; ++c) {
+            event.mContactPointOn1[c] = point1[c];
+            event.mContactPointOn2[c] = point2[c];
+        }
+        event.mNumPoints = num_points;
+    }
+
+    inline static std::atomic<uint64> sNextID = 1;
+
+    uint64 mID = sNextID++;
+    bool mRecordAdded;
+    bool mRecordPersisted;
+    bool mRecordRemoved;
+    ContactListener *mChained = nullptr;
+    bool mChainValidate = false;
+    bool mChainAdded = false;
+    bool mChainPersisted = false;
+    bool mChainRemoved = false;
+    Array<std::unique_ptr<ThreadBuffer>> mBuffers;             ///< Allocated up front, never resized
+    std::atomic<uint> mNumClaimed = 0;
+    std::mutex mOverflowMutex;
+    Array<std::unique_ptr<ThreadBuffer>> mOverflow;
+};
+
+void BindBufferedContactListener(nb::module_ &m) {
+    nb::class_<BufferedContactListener, ContactListener>(m, "BufferedContactListener",
+        "Contact listener that buffers the added, persisted and removed contact events per thread without calling into Python during PhysicsSystem.update.\n"
+        "After the update, drain() returns the events as NumPy arrays with a structured dtype.\n"
+        "A Python listener can be chained for the callbacks that need to run during the update, this will lock the GIL for those callbacks.")
+        .def(nb::init<bool, bool, bool, uint>(), "record_added"_a = true, "record_persisted"_a = true, "record_removed"_a = true, "max_threads"_a = 0,
+            "Args:\n"
+            "    record_added (bool): Buffer on_contact_added events.\n"
+            "    record_persisted (bool): Buffer on_contact_persisted events.\n"
+            "    record_removed (bool): Buffer on_contact_removed events.\n"
+            "    max_threads (int): Number of per thread buffers allocated up front, 0 for one per hardware thread plus one. Threads claim a buffer without locking,\n"
+            "        threads beyond this number take a lock once on their first event. Use at least the number of job system threads plus one.")
+        .def("set_chained_listener", &BufferedContactListener::SetChainedListener, "listener"_a.none(), "validate"_a = false, "added"_a = false, "persisted"_a = false, "removed"_a = false,
+            nb::keep_alive<1, 2>(),
+            "Forward the selected callbacks to listener before they are buffered, any changes the listener makes to the contact settings are reflected in the buffered events.\n"
+            "Args:\n"
+            "    listener (ContactListener): Listener to forward to, None to stop forwarding.\n"
+            "    validate (bool): Forward on_contact_validate, when not forwarded all contacts are accepted.\n"
+            "    added (bool): Forward on_contact_added.\n"
+            "    persisted (bool): Forward on_contact_persisted.\n"
+            "    removed (bool): Forward on_contact_removed.")
+        .def("drain", [](BufferedContactListener &self, bool sort) {
+            {
+                nb::gil_scoped_release release;
+                self.Gather(sort);
+            }
+            nb::dict result;
+            result["added"] = RecordsToNumpy<ContactEvent>(self.mAdded.mEvents.data(), self.mAdded.mEvents.size());
+            result["added_points"] = RecordsToNumpy<ContactEventPoint>(self.mAdded.mPoints.data(), self.mAdded.mPoints.size());
+            result["persisted"] = RecordsToNumpy<ContactEvent>(self.mPersisted.mEvents.data(), self.mPersisted.mEvents.size());
+            result["persisted_points"] = RecordsToNumpy<ContactEventPoint>(self.mPersisted.mPoints.data(), self.mPersisted.mPoints.size());
+            result["removed"] = RecordsToNumpy<ContactEvent>(self.mRemoved.mEvents.data(), self.mRemoved.mEvents.size());
+            return result;
+        }, "sort"_a = false,
+            "Take all buffered events, call after PhysicsSystem.update and not while it is running.\n"
+            "Args:\n"
+            "    sort (bool): Sort the events on body and sub shape IDs, without sorting the order depends on which thread detected the contact.\n"
+            "Returns:\n"
+            "    dict: 'added', 'persisted' and 'removed' arrays with fields body_id1, body_id2, sub_shape_id1, sub_shape_id2, contact_point_on1, contact_point_on2 (center of the world space contact points),\n"
+            "    normal, penetration_depth, first_point, num_points, combined_friction and combined_restitution. Removed events only have the body and sub shape IDs filled in.\n"
+            "    'added_points' and 'persisted_points' hold all world space contact points (fields point_on1, point_on2) of the manifolds,\n"
+            "    the points of an event are points[first_point:first_point + num_points].")
+        .def("clear", &BufferedContactListener::Clear,
+            "Drop all buffered events");
+}
@@ -0,0 +1,231 @@
+#include "Common.h"
+#include <Jolt/Physics/Collision/ContactListener.h>
+#include <Jolt/Physics/Collision/CollideShape.h>
+#include <Jolt/Physics/Collision/PhysicsMaterial.h>
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Core/QuickSort.h>
+#include "BindingUtility/NumpyRows.h"
+#include <nanobind/stl/optional.h>
+#include <algorithm>
+#include <optional>
+
+/// Contact listener that modifies contacts according to a table of rules, evaluated natively on the physics worker threads.
+/// A rule matches when its conditions hold for one of the bodies (the subject) and the other body (the other).
+/// Matching rules are applied in the order they were added, so later rules override earlier ones. A rule that matches with either body as the subject
+/// is applied for body 1 and then for body 2: surface velocities of both add up, for the other actions body 2 wins.
+class ContactRulesListener : public ContactListener {
+  public:
+    struct Rule {
+        // Conditions, an unset condition always matches
+        ObjectLayer mLayer = cObjectLayerInvalid;
+        ObjectLayer mOtherLayer = cObjectLayerInvalid;
+        Array<BodyID> mBodyIDs;
+        uint64 mUserDataMask = 0;
+        uint64 mUserDataValue = 0;
+        uint64 mSubShapeUserDataMask = 0;
+        uint64 mSubShapeUserDataValue = 0;
+        RefConst<PhysicsMaterial> mMaterial;
+
+        // Actions
+        bool mReject = false;
+        std::optional<float> mFriction;
+        std::optional<float> mRestitution;
+        std::optional<bool> mIsSensor;
+        std::optional<float> mInvMassScale;
+        std::optional<float> mInvInertiaScale;
+        std::optional<float> mOtherInvMassScale;
+        std::optional<float> mOtherInvInertiaScale;
+        std::optional<Vec3> mSurfaceVelocity;
+        std::optional<Vec3> mAngularSurfaceVelocity;
+
+        /// If this rule looks at the individual sub shapes instead of only the bodies
+        inline bool HasSubShapeCondition() const {
+            return mSubShapeUserDataMask != 0 || mMaterial != nullptr;
+        }
+    };
+
+    /// Add a rule, returns its index. Do not modify the rules while the simulation is running.
+    uint AddRule(Rule inRule) {
+        QuickSort(inRule.mBodyIDs.begin(), inRule.mBodyIDs.end());
+        if (inRule.mReject && inRule.HasSubShapeCondition())
+            mHasSubShapeRejectRule = true;
+        mRules.push_back(std::move(inRule));
+        return (uint)mRules.size() - 1;
+    }
+
+    void ClearRules() {
+        mRules.clear();
+        mHasSubShapeRejectRule = false;
+    }
+
+    inline uint GetNumRules() const {
+        return (uint)mRules.size();
+    }
+
+    void SetChainedListener(ContactListener *inListener) {
+        mChained = inListener;
+    }
+
+    virtual ValidateResult OnContactValidate(const Body &inBody1, const Body &inBody2, RVec3Arg inBaseOffset, const CollideShapeResult &inCollisionResult) override {
+        for (const Rule &rule : mRules)
+            if (rule.mReject
+                && (sMatches(rule, inBody1, inCollisionResult.mSubShapeID1, inBody2) || sMatches(rule, inBody2, inCollisionResult.mSubShapeID2, inBody1)))
+                return rule.HasSubShapeCondition() ? ValidateResult::RejectContact : ValidateResult::RejectAllContactsForThisBodyPair;
+
+        // When rejecting depends on the sub shapes we need to see every manifold of the pair, also when the chained listener would accept them all
+        ValidateResult result = mChained != nullptr ? mChained->OnContactValidate(inBody1, inBody2, inBaseOffset, inCollisionResult) : ValidateResult::AcceptAllContactsForThisBodyPair;
+        if (mHasSubShapeRejectRule && result == ValidateResult::AcceptAllContactsForThisBodyPair)
+            return ValidateResult::AcceptContact;
+        return result;
+    }
+
+    virtual void OnContactAdded(const Body &inBody1, const Body &inBody2, const ContactManifold &inManifold, ContactSettings &ioSettings) override {
+        ApplyRules(inBody1, inBody2, inManifold, ioSettings);
+        if (mChained != nullptr)
+            mChained->OnContactAdded(inBody1, inBody2, inManifold, ioSettings);
+    }
+
+    virtual void OnContactPersisted(const Body &inBody1, const Body &inBody2, const ContactManifold &inManifold, ContactSettings &ioSettings) override {
+        ApplyRules(inBody1, inBody2, inManifold, ioSettings);
+        if (mChained != nullptr)
+            mChained->OnContactPersisted(inBody1, inBody2, inManifold, ioSettings);
+    }
+
+    virtual void OnContactRemoved(const SubShapeIDPair &inSubShapePair) override {
+        if (mChained != nullptr)
+            mChained->OnContactRemoved(inSubShapePair);
+    }
+
+  private:
+    static bool sMatches(const Rule &inRule, const Body &inSubject, const SubShapeID &inSubjectSubShapeID, const Body &inOther) {
+        if (inRule.mLayer != cObjectLayerInvalid && inSubject.GetObjectLayer() != inRule.mLayer)
+            return false;
+        if (inRule.mOtherLayer != cObjectLayerInvalid && inOther.GetObjectLayer() != inRule.mOtherLayer)
+            return false;
+        if (!inRule.mBodyIDs.empty() && !std::binary_search(inRule.mBodyIDs.begin(), inRule.mBodyIDs.end(), inSubject.GetID()))
+            return false;
+        if ((inSubject.GetUserData() & inRule.mUserDataMask) != inRule.mUserDataValue)
+            return false;
+        if (inRule.mSubShapeUserDataMask != 0 && (inSubject.GetShape()->GetSubShapeUserData(inSubjectSubShapeID) & inRule.mSubShapeUserDataMask) != inRule.mSubShapeUserDataValue)
+            return false;
+        if (inRule.mMaterial != nullptr && inSubject.GetShape()->GetMaterial(inSubjectSubShapeID) != inRule.mMaterial)
+            return false;
+        return true;
+    }
+
+    void ApplyRules(const Body &inBody1, const Body &inBody2, const ContactManifold &inManifold, ContactSettings &ioSettings) const {
+        for (const Rule &rule : mRules) {
+            if (sMatches(rule, inBody1, inManifold.mSubShapeID1, inBody2))
+                sApply(rule, inBody1, inBody2, false, ioSettings);
+            if (sMatches(rule, inBody2, inManifold.mSubShapeID2, inBody1))
+                sApply(rule, inBody1, inBody2, true, ioSettings);
+        }
+    }
+
+    static void sApply(const Rule &inRule, const Body &inBody1, const Body &inBody2, bool inSubjectIsBody2, ContactSettings &ioSettings) {
+        if (inRule.mFriction)
+            ioSettings.mCombinedFriction = *inRule.mFriction;
+        if (inRule.mRestitution)
+            ioSettings.mCombinedRestitution = *inRule.mRestitution;
+        if (inRule.mIsSensor)
+            ioSettings.mIsSensor = *inRule.mIsSensor;
+
+        float &subject_inv_mass = inSubjectIsBody2 ? ioSettings.mInvMassScale2 : ioSettings.mInvMassScale1;
+        float &subject_inv_inertia = inSubjectIsBody2 ? ioSettings.mInvInertiaScale2 : ioSettings.mInvInertiaScale1;
+        float &other_inv_mass = inSubjectIsBody2 ? ioSettings.mInvMassScale1 : ioSettings.mInvMassScale2;
+        float &other_inv_inertia = inSubjectIsBody2 ? ioSettings.mInvInertiaScale1 : ioSettings.mInvInertiaScale2;
+        if (inRule.mInvMassScale)
+            subject_inv_mass = *inRule.mInvMassScale;
+        if (inRule.mInvInertiaScale)
+            subject_inv_inertia = *inRule.mInvInertiaScale;
+        if (inRule.mOtherInvMassScale)
+            other_inv_mass = *inRule.mOtherInvMassScale;
+        if (inRule.mOtherInvInertiaScale)
+            other_inv_inertia = *inRule.mOtherInvInertiaScale;
+
+        // Surface velocities are specified in the local space of the subject, the contact wants them as body 2 - body 1
+        const Body &subject = inSubjectIsBody2 ? inBody2 : inBody1;
+        float sign = inSubjectIsBody2 ? 1.0f : -1.0f;
+        if (inRule.mSurfaceVelocity)
+            ioSettings.mRelativeLinearSurfaceVelocity += sign * (subject.GetRotation() * *inRule.mSurfaceVelocity);
+        if (inRule.mAngularSurfaceVelocity) {
+            Vec3 angular = subject.GetRotation() * *inRule.mAngularSurfaceVelocity;
+            ioSettings.mRelativeAngularSurfaceVelocity += sign * angular;
+
+            // The relative angular velocity is around the center of mass of body 1, compensate when it is body 2 that rotates
+            if (inSubjectIsBody2)
+                ioSettings.mRelativeLinearSurfaceVelocity += angular.Cross(Vec3(inBody1.GetCenterOfMassPosition() - inBody2.GetCenterOfMassPosition()));
+        }
+    }
+
+    Array<Rule> mRules;
+    bool mHasSubShapeRejectRule = false;
+    ContactListener *mChained = nullptr;
+};
+
+void BindContactRulesListener(nb::module_ &m) {
+    nb::class_<ContactRulesListener, ContactListener>(m, "ContactRulesListener",
+        "Contact listener that modifies contacts according to a table of rules, all rules are evaluated in C++ on the physics worker threads.\n"
+        "A rule matches when its conditions hold for one of the two bodies (the subject) and the other body. Matching rules are applied in the order they were added,\n"
+        "so later rules override earlier ones. A rule that matches for both bodies is applied for both, e.g. two conveyor belts add their surface velocities,\n"
+        "for the other actions the rule for body 2 wins. Do not modify the rules while PhysicsSystem.update is running.")
+        .def(nb::init<>())
+        .def("add_rule", [](ContactRulesListener &self, std::optional<ObjectLayer> layer, std::optional<ObjectLayer> other_layer, const NumpyBodyIDs &body_ids,
+                            uint64 user_data_mask, uint64 user_data_value, uint64 sub_shape_user_data_mask, uint64 sub_shape_user_data_value, const PhysicsMaterial *material,
+                            bool reject, std::optional<float> friction, std::optional<float> restitution, std::optional<bool> is_sensor,
+                            std::optional<float> inv_mass_scale, std::optional<float> inv_inertia_scale, std::optional<float> other_inv_mass_scale, std::optional<float> other_inv_inertia_scale,
+                            std::optional<Vec3> surface_velocity, std::optional<Vec3> angular_surface_velocity) {
+            ContactRulesListener::Rule rule;
+            rule.mLayer = layer.value_or(cObjectLayerInvalid);
+            rule.mOtherLayer = other_layer.value_or(cObjectLayerInvalid);
+            if (body_ids.is_valid())
+                rule.mBodyIDs.assign(ToBodyIDs(body_ids), ToBodyIDs(body_ids) + body_ids.shape(0));
+            rule.mUserDataMask = user_data_mask;
+            rule.mUserDataValue = user_data_value & user_data_mask;
+            rule.mSubShapeUserDataMask = sub_shape_user_data_mask;
+            rule.mSubShapeUserDataValue = sub_shape_user_data_value & sub_shape_user_data_mask;
+            rule.mMaterial = material;
+            rule.mReject = reject;
+            rule.mFriction = friction;
+            rule.mRestitution = restitution;
+            rule.mIsSensor = is_sensor;
+            rule.mInvMassScale = inv_mass_scale;
+            rule.mInvInertiaScale = inv_inertia_scale;
+            rule.mOtherInvMassScale = other_inv_mass_scale;
+            rule.mOtherInvInertiaScale = other_inv_inertia_scale;
+            rule.mSurfaceVelocity = surface_velocity;
+            rule.mAngularSurfaceVelocity = angular_surface_velocity;
+            return self.AddRule(std::move(rule));
+        }, "layer"_a = nb::none(), "other_layer"_a = nb::none(), "body_ids"_a.none() = nb::none(),
+            "user_data_mask"_a = 0, "user_data_value"_a = 0, "sub_shape_user_data_mask"_a = 0, "sub_shape_user_data_value"_a = 0, "material"_a.none() = nb::none(),
+            "reject"_a = false, "friction"_a = nb::none(), "restitution"_a = nb::none(), "is_sensor"_a = nb::none(),
+            "inv_mass_scale"_a = nb::none(), "inv_inertia_scale"_a = nb::none(), "other_inv_mass_scale"_a = nb::none(), "other_inv_inertia_scale"_a = nb::none(),
+            "surface_velocity"_a = nb::none(), "angular_surface_velocity"_a = nb::none(),
+            "Add a rule, returns the index of the rule.\n"
+            "Args:\n"
+            "    layer (int): Object layer of the subject.\n"
+            "    other_layer (int): Object layer of the other body.\n"
+            "    body_ids (ndarray): uint32 array with the body IDs the subject must be one of.\n"
+            "    user_data_mask (int): Bits of the subject body user data to test.\n"
+            "    user_data_value (int): Required value of the masked body user data bits.\n"
+            "    sub_shape_user_data_mask (int): Bits of the user data of the subject's sub shape in contact to test.\n"
+            "    sub_shape_user_data_value (int): Required value of the masked sub shape user data bits.\n"
+            "    material (PhysicsMaterial): Material the subject's sub shape (e.g. mesh triangle) in contact must have.\n"
+            "    reject (bool): Reject the contact in on_contact_validate. Rules with a sub shape condition reject only the contact, other rules the whole body pair.\n"
+            "    friction (float): Combined friction.\n"
+            "    restitution (float): Combined restitution.\n"
+            "    is_sensor (bool): Treat the contact as sensor.\n"
+            "    inv_mass_scale (float): Inverse mass scale of the subject.\n"
+            "    inv_inertia_scale (float): Inverse inertia scale of the subject.\n"
+            "    other_inv_mass_scale (float): Inverse mass scale of the other body.\n"
+            "    other_inv_inertia_scale (float): Inverse inertia scale of the other body.\n"
+            "    surface_velocity (Vec3): Linear surface velocity of the subject in its local space, e.g. a conveyor belt.\n"
+            "    angular_surface_velocity (Vec3): Angular surface velocity of the subject in its local space, e.g. a turntable.\n"
+            "Returns:\n"
+            "    int: Index of the rule.")
+        .def("clear_rules", &ContactRulesListener::ClearRules)
+        .def("get_num_rules", &ContactRulesListener::GetNumRules)
+        .def("set_chained_listener", &ContactRulesListener::SetChainedListener, "listener"_a.none(), nb::keep_alive<1, 2>(),
+            "Forward all callbacks to listener after the rules have been applied (e.g. a BufferedContactListener), None to stop forwarding.\n"
+            "When no rule rejects the contact, on_contact_validate returns the result of listener.");
+}
@@ -0,0 +1,53 @@
+#include "Common.h"
+#include "BindingUtility/DeltaStateRecorder.h"
+#include "BindingUtility/NativeStreams.h"
+
+void BindDeltaStateRecorder(nb::module_ &m) {
+    nb::class_<DeltaStateRecorder>(m, "DeltaStateRecorder",
+        "Saves only the bodies that changed relative to a base state, plus the constraints and contacts that involve them.\n"
+        "Typical use: save a full keyframe with PhysicsSystem.save_state and call set_base, then save a delta per tick into a StreamOutMemory.\n"
+        "To reconstruct, restore the keyframe and apply the deltas in order (with update_base=True) or only the wanted delta (with update_base=False).")
+        .def(nb::init<PhysicsSystem &, float, float, float>(), "physics_system"_a, "position_tolerance"_a = 0.0f, "rotation_tolerance"_a = 0.0f, "velocity_tolerance"_a = 0.0f,
+            nb::keep_alive<1, 2>(),
+            "Args:\n"
+            "    physics_system (PhysicsSystem): System to record.\n"
+            "    position_tolerance (float): Bodies that moved less than this distance count as unchanged, 0 to only skip exactly equal bodies.\n"
+            "    rotation_tolerance (float): Max distance between the rotation quaternions of an unchanged body.\n"
+            "    velocity_tolerance (float): Max change of linear and angular velocity of an unchanged body.")
+        .def("set_base", &DeltaStateRecorder::SetBase, nb::call_guard<nb::gil_scoped_release>(),
+            "Use the current state of all bodies as the base for the next deltas")
+        .def("save_delta", [](DeltaStateRecorder &self, nb::handle stream, bool update_base) {
+            StreamOutArg out(stream);
+            uint num_changed;
+            bool ok;
+            {
+                nb::gil_scoped_release release;
+                num_changed = self.SaveDelta(out.Get(), update_base);
+                ok = out.Flush();
+            }
+            if (!ok)
+                throw std::runtime_error("Failed to save delta, the stream failed.");
+            return num_changed;
+        }, "stream"_a, "update_base"_a = true,
+            "Write the changed bodies, constraints and contacts to stream.\n"
+            "Args:\n"
+            "    stream (StreamOut | file-like): Destination, e.g. a StreamOutMemory.\n"
+            "    update_base (bool): Make the saved bodies part of the base, so the next delta is relative to this one and deltas are applied in order.\n"
+            "Returns:\n"
+            "    int: Number of bodies in the delta.")
+        .def_static("apply_delta", [](PhysicsSystem &physics_system, nb::handle stream) {
+            StreamInArg in(stream);
+            nb::gil_scoped_release release;
+            return DeltaStateRecorder::sApplyDelta(physics_system, in.Get());
+        }, "physics_system"_a, "stream"_a,
+            "Read one delta from stream and restore it on top of the current state.\n"
+            "Args:\n"
+            "    physics_system (PhysicsSystem): System to restore, it must contain the state the delta is relative to.\n"
+            "    stream (StreamIn | bytes-like | file-like): Source, consecutive deltas can be read from the same StreamIn or file.\n"
+            "Returns:\n"
+            "    bool: False if the data is not a delta, is truncated, lists more bodies than physics_system can hold or could not be restored.")
+        .def("get_num_base_bodies", &DeltaStateRecorder::GetNumBaseBodies,
+            "Size of the table with base states, indexed by body index")
+        .def("get_last_state_size", &DeltaStateRecorder::GetLastStateSize,
+            "Size in bytes of the physics state in the last delta (excluding the list of bodies)");
+}
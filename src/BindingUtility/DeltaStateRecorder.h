@@ -0,0 +1,208 @@
+#pragma once
+#include "Common.h"
+#include "BindingUtility/StateRecorderBuffer.h"
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Physics/Constraints/TwoBodyConstraint.h>
+#include <Jolt/Core/QuickSort.h>
+#include <algorithm>
+#include <limits>
+
+/// Records the state of only the bodies that changed relative to a base, together with the constraints and contacts that involve them.
+/// A delta is restored on top of the base state (or on top of the previous delta when the base is updated after every delta).
+///
+/// Layout of a delta: magic, number of changed bodies, their BodyIDs (sorted), size of the state, partial state as written by PhysicsSystem::SaveState.
+class DeltaStateRecorder {
+  public:
+    static constexpr uint32 cMagic = 0x544c444a; // 'JDLT'
+
+    /// Granularity with which the state of a delta is read
+    static constexpr size_t cReadChunkSize = 64 * 1024;
+
+    /// Saves the bodies in a sorted list of BodyIDs, and the constraints and contacts that touch one of them
+    class ChangedBodiesFilter : public StateRecorderFilter {
+      public:
+        explicit ChangedBodiesFilter(const Array<uint32> &inBodies) :
+            mBodies(inBodies) {
+        }
+
+        inline bool Contains(const BodyID &inBody) const {
+            return std::binary_search(mBodies.begin(), mBodies.end(), inBody.GetIndexAndSequenceNumber());
+        }
+
+        virtual bool ShouldSaveBody(const Body &inBody) const override {
+            return Contains(inBody.GetID());
+        }
+
+        virtual bool ShouldSaveConstraint(const Constraint &inConstraint) const override {
+            // Constraints that are not attached to two bodies (e.g. vehicles) are always saved
+            if (inConstraint.GetType() != EConstraintType::TwoBodyConstraint)
+                return true;
+            const TwoBodyConstraint &two_body = static_cast<const TwoBodyConstraint &>(inConstraint);
+            return Contains(two_body.GetBody1()->GetID()) || Contains(two_body.GetBody2()->GetID());
+        }
+
+        virtual bool ShouldSaveContact(const BodyID &inBody1, const BodyID &inBody2) const override {
+            return Contains(inBody1) || Contains(inBody2);
+        }
+
+        virtual bool ShouldRestoreContact(const BodyID &inBody1, const BodyID &inBody2) const override {
+            return Contains(inBody1) || Contains(inBody2);
+        }
+
+      private:
+        const Array<uint32> &mBodies;
+    };
+
+    DeltaStateRecorder(PhysicsSystem &inSystem, float inPositionTolerance, float inRotationTolerance, float inVelocityTolerance) :
+        mSystem(inSystem),
+        mPositionToleranceSq(Square(inPositionTolerance)),
+        mRotationToleranceSq(Square(inRotationTolerance)),
+        mVelocityToleranceSq(Square(inVelocityTolerance)) {
+    }
+
+    /// Remember the current state of all bodies as the base
+    void SetBase() {
+        mBase.clear();
+        mSystem.GetBodies(mBodyIDs);
+        const BodyLockInterfaceNoLock &lock_interface = mSystem.GetBodyLockInterfaceNoLock();
+        for (const BodyID &id : mBodyIDs) {
+            const Body *body = lock_interface.TryGetBody(id);
+            if (body != nullptr)
+                StoreBase(*body);
+        }
+    }
+
+    /// Write the state of the bodies that differ from the base to ioStream, returns the number of changed bodies.
+    /// When inUpdateBase is set the changed bodies become the new base, so the next delta is relative to this one.
+    uint SaveDelta(StreamOut &ioStream, bool inUpdateBase) {
+        // Find the bodies that changed
+        mChanged.clear();
+        mSystem.GetBodies(mBodyIDs);
+        const BodyLockInterfaceNoLock &lock_interface = mSystem.GetBodyLockInterfaceNoLock();
+        for (const BodyID &id : mBodyIDs) {
+            const Body *body = lock_interface.TryGetBody(id);
+            if (body != nullptr && HasChanged(*body))
+                mChanged.push_back(id.GetIndexAndSequenceNumber());
+        }
+        QuickSort(mChanged.begin(), mChanged.end());
+
+        // Let the physics system write the partial state
+        ChangedBodiesFilter filter(mChanged);
+        mState.Clear();
+        mSystem.SaveState(mState, EStateRecorderState::All, &filter);
+
+        ioStream.Write(cMagic);
+        ioStream.Write(uint32(mChanged.size()));
+        ioStream.WriteBytes(mChanged.data(), mChanged.size() * sizeof(uint32));
+        ioStream.Write(uint64(mState.GetReadSize()));
+        ioStream.WriteBytes(mState.GetReadData(), mState.GetReadSize());
+
+        if (inUpdateBase)
+            for (uint32 id : mChanged) {
+                const Body *body = lock_interface.TryGetBody(BodyID(id));
+                if (body != nullptr)
+                    StoreBase(*body);
+            }
+
+        return uint(mChanged.size());
+    }
+
+    /// Read a delta from ioStream and restore it on top of the current state of inSystem
+    static bool sApplyDelta(PhysicsSystem &inSystem, StreamIn &ioStream) {
+        uint32 magic = 0, num_changed = 0;
+        ioStream.Read(magic);
+        ioStream.Read(num_changed);
+        if (ioStream.IsFailed() || magic != cMagic || num_changed > inSystem.GetMaxBodies())
+            return false;
+
+        Array<uint32> changed;
+        changed.resize(num_changed);
+        ioStream.ReadBytes(changed.data(), num_changed * sizeof(uint32));
+
+        uint64 state_size = 0;
+        ioStream.Read(state_size);
+        if (ioStream.IsFailed())
+            return false;
+
+        // The size comes from the stream, so grow the buffer as the data arrives: a corrupt size fails at the end of the stream instead of allocating it up front
+        if (state_size > std::numeric_limits<size_t>::max())
+            return false;
+        Array<uint8> data;
+        for (size_t size = 0; size < state_size; ) {
+            size_t num_bytes = size_t(min(state_size - size, uint64(cReadChunkSize)));
+            if (data.capacity() < size + num_bytes)
+                data.reserve(max(size + num_bytes, 2 * data.capacity()));
+            data.resize(size + num_bytes);
+            ioStream.ReadBytes(data.data() + size, num_bytes);
+            if (ioStream.IsFailed())
+                return false;
+            size += num_bytes;
+        }
+
+        StateRecorderBuffer state;
+        state.SetExternalData(data.data(), data.size());
+
+        ChangedBodiesFilter filter(changed);
+        return inSystem.RestoreState(state, &filter);
+    }
+
+    inline const PhysicsSystem &GetSystem() const {
+        return mSystem;
+    }
+
+    inline size_t GetNumBaseBodies() const {
+        return mBase.size();
+    }
+
+    /// Size of the state part of the last delta in bytes
+    inline size_t GetLastStateSize() const {
+        return mState.GetReadSize();
+    }
+
+  private:
+    struct BaseBody {
+        uint32 mID = BodyID::cInvalidBodyID;
+        RVec3 mPosition;
+        Quat mRotation;
+        Vec3 mLinearVelocity;
+        Vec3 mAngularVelocity;
+        bool mIsActive = false;
+    };
+
+    void StoreBase(const Body &inBody) {
+        uint32 index = inBody.GetID().GetIndex();
+        if (index >= mBase.size())
+            mBase.resize(index + 1);
+        BaseBody &base = mBase[index];
+        base.mID = inBody.GetID().GetIndexAndSequenceNumber();
+        base.mPosition = inBody.GetPosition();
+        base.mRotation = inBody.GetRotation();
+        base.mLinearVelocity = inBody.GetLinearVelocity();
+        base.mAngularVelocity = inBody.GetAngularVelocity();
+        base.mIsActive = inBody.IsActive();
+    }
+
+    bool HasChanged(const Body &inBody) const {
+        // Bodies that were added after the base was taken are always saved
+        uint32 index = inBody.GetID().GetIndex();
+        if (index >= mBase.size() || mBase[index].mID != inBody.GetID().GetIndexAndSequenceNumber())
+            return true;
+
+        const BaseBody &base = mBase[index];
+        return base.mIsActive != inBody.IsActive()
+            || !base.mPosition.IsClose(inBody.GetPosition(), mPositionToleranceSq)
+            || !base.mRotation.IsClose(inBody.GetRotation(), mRotationToleranceSq)
+            || !base.mLinearVelocity.IsClose(inBody.GetLinearVelocity(), mVelocityToleranceSq)
+            || !base.mAngularVelocity.IsClose(inBody.GetAngularVelocity(), mVelocityToleranceSq);
+    }
+
+    PhysicsSystem &mSystem;
+    float mPositionToleranceSq;
+    float mRotationToleranceSq;
+    float mVelocityToleranceSq;
+    Array<BaseBody> mBase;
+    BodyIDVector mBodyIDs;
+    Array<uint32> mChanged;
+    StateRecorderBuffer mState;
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include "Common.h"
+#include <Jolt/Physics/Collision/BroadPhase/BroadPhaseLayer.h>
+#include <Jolt/Physics/Collision/BroadPhase/BroadPhaseLayerInterfaceTable.h>
+#include <Jolt/Physics/Collision/BroadPhase/BroadPhaseLayerInterfaceMask.h>
+#include <Jolt/Physics/Collision/BroadPhase/ObjectVsBroadPhaseLayerFilterTable.h>
+#include <Jolt/Physics/Collision/BroadPhase/ObjectVsBroadPhaseLayerFilterMask.h>
+#include <Jolt/Physics/Collision/ObjectLayer.h>
+#include <Jolt/Physics/Collision/ObjectLayerPairFilterTable.h>
+#include <Jolt/Physics/Collision/ObjectLayerPairFilterMask.h>
+#include <string>
+
+/// Snapshot of the layer interface and layer filters passed to PhysicsSystem::Init, evaluated once over all object and broadphase layers.
+/// Filters implemented in Python need the GIL for every pair test on every worker thread, the snapshot answers the same questions from tables.
+/// Layers beyond the snapshot map to broadphase layer 0 and collide with nothing.
+class FrozenLayerFilters {
+  public:
+    /// Object layers that are probed when the number of object layers is not specified
+    static constexpr uint cMaxProbedObjectLayers = 256;
+
+    class BroadPhaseLayerInterfaceImpl : public BroadPhaseLayerInterface {
+      public:
+        virtual uint GetNumBroadPhaseLayers() const override {
+            return mNumBroadPhaseLayers;
+        }
+
+        virtual BroadPhaseLayer GetBroadPhaseLayer(ObjectLayer inLayer) const override {
+            if (inLayer >= mObjectToBroadPhase.size())
+                return BroadPhaseLayer(0);
+            return mObjectToBroadPhase[inLayer];
+        }
+
+#if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
+        virtual const char *GetBroadPhaseLayerName(BroadPhaseLayer inLayer) const override {
+            return mNames[(BroadPhaseLayer::Type)inLayer].c_str();
+        }
+
+        Array<std::string> mNames;
+#endif
+
+        uint mNumBroadPhaseLayers = 0;
+        Array<BroadPhaseLayer> mObjectToBroadPhase;
+    };
+
+    class ObjectVsBroadPhaseLayerFilterImpl : public ObjectVsBroadPhaseLayerFilter {
+      public:
+        virtual bool ShouldCollide(ObjectLayer inLayer1, BroadPhaseLayer inLayer2) const override {
+            if (inLayer1 >= mNumObjectLayers || (BroadPhaseLayer::Type)inLayer2 >= mNumBroadPhaseLayers)
+                return false;
+            return mTable[inLayer1 * mNumBroadPhaseLayers + (BroadPhaseLayer::Type)inLayer2] != 0;
+        }
+
+        uint mNumObjectLayers = 0;
+        uint mNumBroadPhaseLayers = 0;
+        Array<uint8> mTable;
+    };
+
+    class ObjectLayerPairFilterImpl : public ObjectLayerPairFilter {
+      public:
+        virtual bool ShouldCollide(ObjectLayer inLayer1, ObjectLayer inLayer2) const override {
+            if (inLayer1 >= mNumObjectLayers || inLayer2 >= mNumObjectLayers)
+                return false;
+            return mTable[inLayer1 * mNumObjectLayers + inLayer2] != 0;
+        }
+
+        uint mNumObjectLayers = 0;
+        Array<uint8> mTable;
+    };
+
+    /// If the filters are already table based there is nothing to gain by freezing them
+    static bool sIsNative(const BroadPhaseLayerInterface &inBroadPhaseLayerInterface, const ObjectVsBroadPhaseLayerFilter &inObjectVsBroadPhaseLayerFilter, const ObjectLayerPairFilter &inObjectLayerPairFilter) {
+        return (dynamic_cast<const BroadPhaseLayerInterfaceTable *>(&inBroadPhaseLayerInterface) != nullptr || dynamic_cast<const BroadPhaseLayerInterfaceMask *>(&inBroadPhaseLayerInterface) != nullptr)
+            && (dynamic_cast<const ObjectVsBroadPhaseLayerFilterTable *>(&inObjectVsBroadPhaseLayerFilter) != nullptr || dynamic_cast<const ObjectVsBroadPhaseLayerFilterMask *>(&inObjectVsBroadPhaseLayerFilter) != nullptr)
+            && (dynamic_cast<const ObjectLayerPairFilterTable *>(&inObjectLayerPairFilter) != nullptr || dynamic_cast<const ObjectLayerPairFilterMask *>(&inObjectLayerPairFilter) != nullptr);
+    }
+
+    /// Count the object layers by asking the layer interface for consecutive layers until it raises, returns 0 if no end was found
+    static uint sProbeNumObjectLayers(const BroadPhaseLayerInterface &inBroadPhaseLayerInterface) {
+        uint num_broad_phase_layers = inBroadPhaseLayerInterface.GetNumBroadPhaseLayers();
+        for (uint layer = 0; layer < cMaxProbedObjectLayers; ++layer) {
+            try {
+                BroadPhaseLayer bp_layer = inBroadPhaseLayerInterface.GetBroadPhaseLayer(ObjectLayer(layer));
+                if ((BroadPhaseLayer::Type)bp_layer >= num_broad_phase_layers)
+                    return layer;
+            } catch (nb::python_error &) {
+                return layer;
+            } catch (nb::builtin_exception &) {
+                return layer;
+            }
+        }
+        return 0;
+    }
+
+    /// Evaluate all filters for the first inNumObjectLayers object layers, must be called with the GIL held.
+    /// A filter that raises for a pair is recorded as not colliding and counted in mNumFailedPairs, a layer interface that raises aborts the snapshot.
+    FrozenLayerFilters(uint inNumObjectLayers, const BroadPhaseLayerInterface &inBroadPhaseLayerInterface, const ObjectVsBroadPhaseLayerFilter &inObjectVsBroadPhaseLayerFilter, const ObjectLayerPairFilter &inObjectLayerPairFilter) {
+        uint num_bp_layers = inBroadPhaseLayerInterface.GetNumBroadPhaseLayers();
+
+        mBroadPhaseLayerInterface.mNumBroadPhaseLayers = num_bp_layers;
+        mBroadPhaseLayerInterface.mObjectToBroadPhase.resize(inNumObjectLayers);
+        for (uint layer = 0; layer < inNumObjectLayers; ++layer)
+            mBroadPhaseLayerInterface.mObjectToBroadPhase[layer] = inBroadPhaseLayerInterface.GetBroadPhaseLayer(ObjectLayer(layer));
+#if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
+        mBroadPhaseLayerInterface.mNames.resize(num_bp_layers);
+        for (uint bp_layer = 0; bp_layer < num_bp_layers; ++bp_layer)
+            mBroadPhaseLayerInterface.mNames[bp_layer] = inBroadPhaseLayerInterface.GetBroadPhaseLayerName(BroadPhaseLayer(BroadPhaseLayer::Type(bp_layer)));
+#endif
+
+        mObjectVsBroadPhaseLayerFilter.mNumObjectLayers = inNumObjectLayers;
+        mObjectVsBroadPhaseLayerFilter.mNumBroadPhaseLayers = num_bp_layers;
+        mObjectVsBroadPhaseLayerFilter.mTable.resize(inNumObjectLayers * num_bp_layers);
+        for (uint layer = 0; layer < inNumObjectLayers; ++layer)
+            for (uint bp_layer = 0; bp_layer < num_bp_layers; ++bp_layer)
+                mObjectVsBroadPhaseLayerFilter.mTable[layer * num_bp_layers + bp_layer] = Evaluate([&]() { return inObjectVsBroadPhaseLayerFilter.ShouldCollide(ObjectLayer(layer), BroadPhaseLayer(BroadPhaseLayer::Type(bp_layer))); });
+
+        mObjectLayerPairFilter.mNumObjectLayers = inNumObjectLayers;
+        mObjectLayerPairFilter.mTable.resize(inNumObjectLayers * inNumObjectLayers);
+        for (uint layer1 = 0; layer1 < inNumObjectLayers; ++layer1)
+            for (uint layer2 = 0; layer2 < inNumObjectLayers; ++layer2)
+                mObjectLayerPairFilter.mTable[layer1 * inNumObjectLayers + layer2] = Evaluate([&]() { return inObjectLayerPairFilter.ShouldCollide(ObjectLayer(layer1), ObjectLayer(layer2)); });
+    }
+
+    BroadPhaseLayerInterfaceImpl mBroadPhaseLayerInterface;
+    ObjectVsBroadPhaseLayerFilterImpl mObjectVsBroadPhaseLayerFilter;
+    ObjectLayerPairFilterImpl mObjectLayerPairFilter;
+
+    /// Number of pair tests that raised while freezing, together with the message of the first one
+    uint mNumFailedPairs = 0;
+    std::string mFirstError;
+
+  private:
+    template <class ShouldCollideFunction>
+    uint8 Evaluate(const ShouldCollideFunction &inShouldCollide) {
+        try {
+            return inShouldCollide() ? 1 : 0;
+        } catch (nb::python_error &e) {
+            if (mNumFailedPairs++ == 0)
+                mFirstError = e.what();
+        } catch (nb::builtin_exception &e) {
+            if (mNumFailedPairs++ == 0)
+                mFirstError = e.what();
+        }
+        return 0;
+    }
+};
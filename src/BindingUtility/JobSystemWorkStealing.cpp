@@ -0,0 +1,22 @@
+#include "Common.h"
+#include "BindingUtility/JobSystemWorkStealing.h"
+
+void BindJobSystemWorkStealing(nb::module_ &m) {
+    nb::class_<JobSystemWorkStealing, JobSystemWithBarrier>(m, "JobSystemWorkStealing",
+        "Drop-in replacement for JobSystemThreadPool with a job deque per worker thread.\n"
+        "Workers run the jobs they spawn themselves and steal from random other workers when idle,\n"
+        "which avoids contention on a single queue with many threads and large islands.")
+        .def(nb::init<uint, uint, int>(), "max_jobs"_a, "max_barriers"_a, "num_threads"_a = -1)
+        .def(nb::init<>())
+
+        .def("init", &JobSystemWorkStealing::Init, "max_jobs"_a, "max_barriers"_a, "num_threads"_a = -1,
+            "Initialize the job system.\n"
+            "Args:\n"
+            "    max_jobs (int): Max number of jobs that can be allocated at any time\n"
+            "    max_barriers (int): Max number of barriers that can be allocated at any time\n"
+            "    num_threads (int): Number of threads to start (the number of concurrent jobs is 1 more because the main thread will also run jobs while waiting for a barrier to complete). Use -1 to auto detect the amount of CPU's,\n"
+            "        with 0 threads jobs run on the thread that queues them.")
+        .def("get_max_concurrency", &JobSystemWorkStealing::GetMaxConcurrency)
+        .def("set_num_threads", &JobSystemWorkStealing::SetNumThreads, "num_threads"_a,
+            "Change the number of worker threads, must not be called while jobs are running. With 0 threads jobs run on the thread that queues them.");
+}
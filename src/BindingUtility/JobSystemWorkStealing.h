@@ -0,0 +1,279 @@
+#pragma once
+#include "Common.h"
+#include <Jolt/Core/JobSystemWithBarrier.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
+#include <Jolt/Core/Semaphore.h>
+#include <Jolt/Core/Mutex.h>
+#include <Jolt/Core/Profiler.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+/// JobSystem with a job deque per worker thread. Workers push and pop jobs at the back of their own deque
+/// and steal from the front of a random other deque when theirs is empty, so jobs that spawn jobs don't all
+/// contend on a single queue. Idle workers spin for a while before parking on a semaphore.
+/// Without worker threads jobs are executed immediately when they are queued, like JobSystemSingleThreaded does.
+class JobSystemWorkStealing final : public JobSystemWithBarrier {
+  public:
+    JPH_OVERRIDE_NEW_DELETE
+
+    /// Number of steal attempts before an idle worker parks
+    static constexpr uint cSpinCount = 64;
+
+    JobSystemWorkStealing() = default;
+
+    JobSystemWorkStealing(uint inMaxJobs, uint inMaxBarriers, int inNumThreads = -1) {
+        Init(inMaxJobs, inMaxBarriers, inNumThreads);
+    }
+
+    virtual ~JobSystemWorkStealing() override {
+        StopThreads();
+    }
+
+    /// Initialize the job system, see JobSystemThreadPool::Init
+    void Init(uint inMaxJobs, uint inMaxBarriers, int inNumThreads = -1) {
+        JobSystemWithBarrier::Init(inMaxBarriers);
+
+        mJobs.Init(inMaxJobs, inMaxJobs);
+
+        // A job is in at most one deque at a time, so each deque can hold all jobs
+        mQueueCapacity = GetNextPowerOf2(inMaxJobs);
+
+        StartThreads(inNumThreads);
+    }
+
+    virtual int GetMaxConcurrency() const override {
+        return int(mNumThreads) + 1;
+    }
+
+    virtual JobHandle CreateJob(const char *inName, ColorArg inColor, const JobFunction &inJobFunction, uint32 inNumDependencies = 0) override {
+        uint32 index;
+        for (;;) {
+            index = mJobs.ConstructObject(inName, inColor, this, inJobFunction, inNumDependencies);
+            if (index != AvailableJobs::cInvalidObjectIndex)
+                break;
+            JPH_ASSERT(false, "No jobs available!");
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        Job *job = &mJobs.Get(index);
+
+        // Take a reference first, the job may complete as soon as it is queued
+        JobHandle handle(job);
+        if (inNumDependencies == 0)
+            QueueJob(job);
+        return handle;
+    }
+
+    /// Change the number of worker threads, must not be called while jobs are running
+    void SetNumThreads(int inNumThreads) {
+        StopThreads();
+        StartThreads(inNumThreads);
+    }
+
+  protected:
+    virtual void QueueJob(Job *inJob) override {
+        // Without workers nobody would pick the job up if it is not waited on through a barrier, so run it on the calling thread
+        if (mNumThreads == 0) {
+            inJob->Execute();
+            return;
+        }
+
+        PushJob(inJob);
+        WakeWorkers(1);
+    }
+
+    virtual void QueueJobs(Job **inJobs, uint inNumJobs) override {
+        JPH_ASSERT(inNumJobs > 0);
+        if (mNumThreads == 0) {
+            for (Job **job = inJobs, **job_end = inJobs + inNumJobs; job < job_end; ++job)
+                (*job)->Execute();
+            return;
+        }
+
+        for (Job **job = inJobs, **job_end = inJobs + inNumJobs; job < job_end; ++job)
+            PushJob(*job);
+        WakeWorkers(inNumJobs);
+    }
+
+    virtual void FreeJob(Job *inJob) override {
+        mJobs.DestructObject(inJob);
+    }
+
+  private:
+    using AvailableJobs = FixedSizeFreeList<Job>;
+
+    /// Ring buffer of jobs, the owner uses the back and thieves take from the front
+    struct alignas(JPH_CACHE_LINE_SIZE) WorkQueue {
+        void Push(Job *inJob, uint inMask) {
+            std::lock_guard lock(mMutex);
+            uint tail = mTail.load(std::memory_order_relaxed);
+            JPH_ASSERT(tail - mHead.load(std::memory_order_relaxed) <= inMask);
+            mJobs[tail & inMask] = inJob;
+            mTail.store(tail + 1);
+        }
+
+        Job *PopBack(uint inMask) {
+            if (IsEmpty())
+                return nullptr;
+            std::lock_guard lock(mMutex);
+            uint head = mHead.load(std::memory_order_relaxed), tail = mTail.load(std::memory_order_relaxed);
+            if (head == tail)
+                return nullptr;
+            mTail.store(tail - 1, std::memory_order_relaxed);
+            return mJobs[(tail - 1) & inMask];
+        }
+
+        Job *StealFront(uint inMask) {
+            if (IsEmpty())
+                return nullptr;
+            std::lock_guard lock(mMutex);
+            uint head = mHead.load(std::memory_order_relaxed), tail = mTail.load(std::memory_order_relaxed);
+            if (head == tail)
+                return nullptr;
+            mHead.store(head + 1, std::memory_order_relaxed);
+            return mJobs[head & inMask];
+        }
+
+        inline bool IsEmpty() const {
+            return mHead.load() == mTail.load();
+        }
+
+        Mutex mMutex;
+        Array<Job *> mJobs;
+        std::atomic<uint> mHead = 0;
+        std::atomic<uint> mTail = 0;
+    };
+
+    void StartThreads(int inNumThreads) {
+        if (inNumThreads < 0)
+            inNumThreads = std::thread::hardware_concurrency() - 1;
+        if (inNumThreads <= 0)
+            return;
+
+        mNumThreads = uint(inNumThreads);
+        mQueues = std::make_unique<WorkQueue[]>(mNumThreads);
+        for (uint i = 0; i < mNumThreads; ++i)
+            mQueues[i].mJobs.resize(mQueueCapacity);
+
+        mQuit = false;
+        mThreads.reserve(mNumThreads);
+        for (uint i = 0; i < mNumThreads; ++i)
+            mThreads.emplace_back([this, i] { ThreadMain(i); });
+    }
+
+    void StopThreads() {
+        if (mThreads.empty())
+            return;
+
+        mQuit = true;
+        mSemaphore.Release(mNumThreads);
+        for (std::thread &t : mThreads)
+            t.join();
+        mThreads.clear();
+
+        // Jobs can be left behind if they were queued after the workers saw the quit flag
+        for (uint i = 0; i < mNumThreads; ++i)
+            for (Job *job = mQueues[i].PopBack(mQueueCapacity - 1); job != nullptr; job = mQueues[i].PopBack(mQueueCapacity - 1)) {
+                job->Execute();
+                job->Release();
+            }
+
+        mQueues.reset();
+        mNumThreads = 0;
+
+        // Drop wake ups that were not consumed
+        while (mSemaphore.GetValue() > 0)
+            mSemaphore.Acquire();
+    }
+
+    void PushJob(Job *inJob) {
+        // Reference held by the deque
+        inJob->AddRef();
+
+        // Workers keep the jobs they spawn, other threads distribute round robin
+        uint queue = sWorkerSystem == this ? sWorkerIndex : mNextQueue.fetch_add(1, std::memory_order_relaxed) % mNumThreads;
+        mQueues[queue].Push(inJob, mQueueCapacity - 1);
+    }
+
+    void WakeWorkers(uint inNumJobs) {
+        // Pairs with the increment of mNumParked in ThreadMain: either the worker sees the new job or we see the parked worker
+        uint num_parked = mNumParked.load();
+        if (num_parked > 0)
+            mSemaphore.Release(min(inNumJobs, num_parked));
+    }
+
+    Job *Steal(uint inThreadIndex, uint32 &ioRandom) {
+        // Xorshift to pick the first victim
+        ioRandom ^= ioRandom << 13;
+        ioRandom ^= ioRandom >> 17;
+        ioRandom ^= ioRandom << 5;
+
+        uint mask = mQueueCapacity - 1;
+        for (uint i = 0, start = ioRandom % mNumThreads; i < mNumThreads; ++i) {
+            uint victim = (start + i) % mNumThreads;
+            if (victim == inThreadIndex)
+                continue;
+            Job *job = mQueues[victim].StealFront(mask);
+            if (job != nullptr)
+                return job;
+        }
+        return nullptr;
+    }
+
+    bool HasQueuedJobs() const {
+        for (uint i = 0; i < mNumThreads; ++i)
+            if (!mQueues[i].IsEmpty())
+                return true;
+        return false;
+    }
+
+    void ThreadMain(uint inThreadIndex) {
+        sWorkerSystem = this;
+        sWorkerIndex = inThreadIndex;
+
+        char name[64];
+        snprintf(name, sizeof(name), "Worker %u", inThreadIndex + 1);
+        JPH_PROFILE_THREAD_START(name);
+
+        uint mask = mQueueCapacity - 1;
+        uint32 random = inThreadIndex * 0x9e3779b9u + 1;
+        while (!mQuit) {
+            Job *job = mQueues[inThreadIndex].PopBack(mask);
+            for (uint spin = 0; job == nullptr && spin < cSpinCount && !mQuit; ++spin) {
+                job = Steal(inThreadIndex, random);
+                if (job == nullptr)
+                    std::this_thread::yield();
+            }
+
+            if (job != nullptr) {
+                // Execute is a no-op if a barrier already executed the job
+                job->Execute();
+                job->Release();
+                continue;
+            }
+
+            // Park, check again after announcing so that a job queued in between is not missed
+            mNumParked.fetch_add(1);
+            if (!HasQueuedJobs())
+                mSemaphore.Acquire();
+            mNumParked.fetch_sub(1);
+        }
+
+        JPH_PROFILE_THREAD_END();
+
+        sWorkerSystem = nullptr;
+    }
+
+    inline static thread_local JobSystemWorkStealing *sWorkerSystem = nullptr;
+    inline static thread_local uint sWorkerIndex = 0;
+
+    AvailableJobs mJobs;
+    uint mQueueCapacity = 0;
+    uint mNumThreads = 0;
+    std::unique_ptr<WorkQueue[]> mQueues;
+    Array<std::thread> mThreads;
+    Semaphore mSemaphore;
+    std::atomic<bool> mQuit = false;
+    std::atomic<uint> mNumParked = 0;
+    std::atomic<uint> mNextQueue = 0;
+};
@@ -0,0 +1,223 @@
+#pragma once
+#include "Common.h"
+#include "BindingUtility/NumpyRows.h"
+#include "BindingUtility/ParallelFor.h"
+#include "BindingUtility/ShapeSettingsLock.h"
+#include <Jolt/Physics/Collision/Shape/MeshShape.h>
+#include <Jolt/Physics/Collision/Shape/StaticCompoundShape.h>
+#include <Jolt/AABBTree/TriangleCodec/TriangleCodecIndexed8BitPackSOA4Flags.h>
+#include <Jolt/Geometry/AABox.h>
+#include <Jolt/Core/HashCombine.h>
+#include <Jolt/Core/QuickSort.h>
+#include <algorithm>
+
+/// (T, 3) array with the vertex indices of the triangles
+using NumpyTriangles = nb::ndarray<nb::numpy, const uint32, nb::shape<-1, 3>, nb::device::cpu, nb::c_contig>;
+
+/// (T,) array with a value per triangle (material index or user data)
+using NumpyTriangleValues = nb::ndarray<nb::numpy, const uint32, nb::shape<-1>, nb::device::cpu, nb::c_contig>;
+
+static constexpr size_t cMeshVerticesPerBatch = 16384;
+static constexpr size_t cMeshTrianglesPerBatch = 16384;
+
+/// Fill the vertices and indexed triangles of ioSettings from arrays, on inJobSystem when it is not null.
+/// inMaterialIndices and inUserData are optional (nullptr) values per triangle. Returns false when a vertex index is out of range.
+/// Call without the GIL.
+inline bool FillMeshShapeSettings(MeshShapeSettings &ioSettings, const NumpyRowReader<3> &inVertices, size_t inNumVertices, const uint32 *inTriangles, size_t inNumTriangles,
+                                  const uint32 *inMaterialIndices, const uint32 *inUserData, JobSystem *inJobSystem) {
+    ioSettings.mTriangleVertices.resize(inNumVertices);
+    ParallelFor(inJobSystem, inNumVertices, cMeshVerticesPerBatch, [&](size_t inBegin, size_t inEnd) {
+        for (size_t v = inBegin; v < inEnd; ++v)
+            inVertices.LoadVec3(v).StoreFloat3(&ioSettings.mTriangleVertices[v]);
+    });
+
+    atomic<bool> out_of_range = false;
+    ioSettings.mIndexedTriangles.resize(inNumTriangles);
+    ParallelFor(inJobSystem, inNumTriangles, cMeshTrianglesPerBatch, [&](size_t inBegin, size_t inEnd) {
+        bool invalid = false;
+        for (size_t t = inBegin; t < inEnd; ++t) {
+            const uint32 *idx = inTriangles + 3 * t;
+            invalid |= idx[0] >= inNumVertices || idx[1] >= inNumVertices || idx[2] >= inNumVertices;
+            ioSettings.mIndexedTriangles[t] = IndexedTriangle(idx[0], idx[1], idx[2],
+                inMaterialIndices != nullptr ? inMaterialIndices[t] : 0,
+                inUserData != nullptr ? inUserData[t] : 0);
+        }
+        if (invalid)
+            out_of_range.store(true, memory_order_relaxed);
+    });
+    return !out_of_range.load(memory_order_relaxed);
+}
+
+/// Parallel version of MeshShapeSettings::Sanitize, removes degenerate triangles and duplicate triangles (the same indices in any rotation,
+/// with the same material and user data). Unlike Sanitize the remaining triangles keep their order. Call without the GIL.
+inline void SanitizeMeshParallel(MeshShapeSettings &ioSettings, JobSystem *inJobSystem) {
+    IndexedTriangleList &triangles = ioSettings.mIndexedTriangles;
+    const VertexList &vertices = ioSettings.mTriangleVertices;
+    size_t num_triangles = triangles.size();
+    if (num_triangles == 0)
+        return;
+
+    // Hash every triangle in its canonical rotation, degenerate triangles (also after quantization by the triangle codec) are dropped
+    TriangleCodecIndexed8BitPackSOA4Flags::ValidationContext validation(triangles, vertices);
+    Array<uint64> hashes(num_triangles);
+    Array<uint8> keep(num_triangles);
+    ParallelFor(inJobSystem, num_triangles, cMeshTrianglesPerBatch, [&](size_t inBegin, size_t inEnd) {
+        for (size_t t = inBegin; t < inEnd; ++t) {
+            const IndexedTriangle &triangle = triangles[t];
+            if (triangle.IsDegenerate(vertices) || validation.IsDegenerate(triangle)) {
+                keep[t] = 0;
+                continue;
+            }
+            IndexedTriangle lowest_first = triangle.GetLowestIndexFirst();
+            hashes[t] = HashBytes(&lowest_first, sizeof(lowest_first));
+            keep[t] = 1;
+        }
+    });
+
+    // Group the triangles in buckets on the top bits of their hash, so that duplicates are always in the same bucket
+    constexpr uint cNumBucketBits = 10;
+    constexpr size_t cNumBuckets = size_t(1) << cNumBucketBits;
+    Array<uint32> bucket_start(cNumBuckets + 1, 0);
+    for (size_t t = 0; t < num_triangles; ++t)
+        if (keep[t])
+            ++bucket_start[(hashes[t] >> (64 - cNumBucketBits)) + 1];
+    for (size_t b = 0; b < cNumBuckets; ++b)
+        bucket_start[b + 1] += bucket_start[b];
+    Array<uint32> bucket_triangles(bucket_start.back());
+    Array<uint32> bucket_fill(bucket_start.begin(), bucket_start.end() - 1);
+    for (size_t t = 0; t < num_triangles; ++t)
+        if (keep[t])
+            bucket_triangles[bucket_fill[hashes[t] >> (64 - cNumBucketBits)]++] = uint32(t);
+
+    // Sort every bucket on hash, the first triangle of every set of equal triangles is kept
+    ParallelFor(inJobSystem, cNumBuckets, 16, [&](size_t inBegin, size_t inEnd) {
+        for (size_t b = inBegin; b < inEnd; ++b) {
+            uint32 *begin = bucket_triangles.data() + bucket_start[b];
+            uint32 *end = bucket_triangles.data() + bucket_start[b + 1];
+            QuickSort(begin, end, [&hashes](uint32 inLHS, uint32 inRHS) {
+                return hashes[inLHS] < hashes[inRHS] || (hashes[inLHS] == hashes[inRHS] && inLHS < inRHS);
+            });
+            for (uint32 *i = begin; i < end; ++i) {
+                if (!keep[*i])
+                    continue;
+                IndexedTriangle lowest_first = triangles[*i].GetLowestIndexFirst();
+                for (uint32 *j = i + 1; j < end && hashes[*j] == hashes[*i]; ++j)
+                    if (keep[*j] && triangles[*j].GetLowestIndexFirst() == lowest_first)
+                        keep[*j] = 0;
+            }
+        }
+    });
+
+    size_t num_kept = 0;
+    for (size_t t = 0; t < num_triangles; ++t)
+        if (keep[t])
+            triangles[num_kept++] = triangles[t];
+    triangles.resize(num_kept);
+}
+
+/// Cook a large mesh on inJobSystem. The triangles are split on their centroids into spatially coherent chunks of at most
+/// inMaxTrianglesPerChunk triangles, every chunk finds its active edges and builds its AABB tree in its own job, and the chunks
+/// are combined in a StaticCompoundShape. Edges on the border between two chunks are always active because a chunk does not see
+/// the triangles of its neighbors. Falls back to MeshShapeSettings::Create for small meshes. Call without the GIL.
+inline ShapeSettings::ShapeResult CreateMeshShapeParallel(const MeshShapeSettings &inSettings, JobSystem *inJobSystem, size_t inMaxTrianglesPerChunk) {
+    const IndexedTriangleList &triangles = inSettings.mIndexedTriangles;
+    const VertexList &vertices = inSettings.mTriangleVertices;
+    size_t num_triangles = triangles.size();
+    if (inJobSystem == nullptr || num_triangles <= inMaxTrianglesPerChunk)
+        return ShapeSettingsLock::sCreate(inSettings);
+
+    // Invalid indices would read outside of the vertex list, let the regular path report them
+    atomic<bool> out_of_range = false;
+    Array<Vec3> centroids(num_triangles);
+    ParallelFor(inJobSystem, num_triangles, cMeshTrianglesPerBatch, [&](size_t inBegin, size_t inEnd) {
+        for (size_t t = inBegin; t < inEnd; ++t) {
+            const IndexedTriangle &triangle = triangles[t];
+            if (triangle.mIdx[0] >= vertices.size() || triangle.mIdx[1] >= vertices.size() || triangle.mIdx[2] >= vertices.size()) {
+                out_of_range.store(true, memory_order_relaxed);
+                centroids[t] = Vec3::sZero();
+                continue;
+            }
+            centroids[t] = (Vec3(vertices[triangle.mIdx[0]]) + Vec3(vertices[triangle.mIdx[1]]) + Vec3(vertices[triangle.mIdx[2]])) / 3.0f;
+        }
+    });
+    if (out_of_range.load(memory_order_relaxed))
+        return ShapeSettingsLock::sCreate(inSettings);
+
+    // Split the ranges at the median centroid along the longest axis of their bounds, one level at a time with the ranges of a level split in parallel
+    struct Range {
+        uint32 mBegin;
+        uint32 mEnd;
+    };
+    Array<uint32> order(num_triangles);
+    for (size_t t = 0; t < num_triangles; ++t)
+        order[t] = uint32(t);
+    Array<Range> chunks;
+    Array<Range> level { Range { 0, uint32(num_triangles) } };
+    while (!level.empty()) {
+        Array<Range> next(2 * level.size());
+        ParallelFor(inJobSystem, level.size(), 1, [&](size_t inBegin, size_t inEnd) {
+            for (size_t r = inBegin; r < inEnd; ++r) {
+                Range range = level[r];
+                AABox bounds;
+                for (uint32 i = range.mBegin; i < range.mEnd; ++i)
+                    bounds.Encapsulate(centroids[order[i]]);
+                int axis = bounds.GetExtent().GetHighestComponentIndex();
+                uint32 middle = range.mBegin + (range.mEnd - range.mBegin) / 2;
+                std::nth_element(order.begin() + range.mBegin, order.begin() + middle, order.begin() + range.mEnd, [&centroids, axis](uint32 inLHS, uint32 inRHS) {
+                    return centroids[inLHS][axis] < centroids[inRHS][axis];
+                });
+                next[2 * r] = Range { range.mBegin, middle };
+                next[2 * r + 1] = Range { middle, range.mEnd };
+            }
+        });
+
+        level.clear();
+        for (const Range &range : next)
+            if (range.mEnd - range.mBegin <= inMaxTrianglesPerChunk)
+                chunks.push_back(range);
+            else
+                level.push_back(range);
+    }
+
+    // Cook the chunks, each one only gets the vertices that it uses
+    Array<ShapeSettings::ShapeResult> results(chunks.size());
+    ParallelFor(inJobSystem, chunks.size(), 1, [&](size_t inBegin, size_t inEnd) {
+        for (size_t c = inBegin; c < inEnd; ++c) {
+            const Range &range = chunks[c];
+
+            Array<uint32> used;
+            used.reserve(3 * (range.mEnd - range.mBegin));
+            for (uint32 i = range.mBegin; i < range.mEnd; ++i)
+                for (uint32 index : triangles[order[i]].mIdx)
+                    used.push_back(index);
+            QuickSort(used.begin(), used.end());
+            used.erase(std::unique(used.begin(), used.end()), used.end());
+
+            Ref<MeshShapeSettings> chunk = new MeshShapeSettings;
+            chunk->mMaterials = inSettings.mMaterials;
+            chunk->mMaxTrianglesPerLeaf = inSettings.mMaxTrianglesPerLeaf;
+            chunk->mActiveEdgeCosThresholdAngle = inSettings.mActiveEdgeCosThresholdAngle;
+            chunk->mPerTriangleUserData = inSettings.mPerTriangleUserData;
+            chunk->mTriangleVertices.resize(used.size());
+            for (size_t v = 0; v < used.size(); ++v)
+                chunk->mTriangleVertices[v] = vertices[used[v]];
+            chunk->mIndexedTriangles.reserve(range.mEnd - range.mBegin);
+            for (uint32 i = range.mBegin; i < range.mEnd; ++i) {
+                IndexedTriangle triangle = triangles[order[i]];
+                for (uint32 &index : triangle.mIdx)
+                    index = uint32(std::lower_bound(used.begin(), used.end(), index) - used.begin());
+                chunk->mIndexedTriangles.push_back(triangle);
+            }
+            results[c] = chunk->Create();
+        }
+    });
+
+    Ref<StaticCompoundShapeSettings> compound = new StaticCompoundShapeSettings;
+    compound->mUserData = inSettings.mUserData;
+    for (const ShapeSettings::ShapeResult &result : results) {
+        if (result.HasError())
+            return result;
+        compound->AddShape(Vec3::sZero(), Quat::sIdentity(), result.Get());
+    }
+    return compound->Create();
+}
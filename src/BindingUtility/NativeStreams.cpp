@@ -0,0 +1,203 @@
+#include "Common.h"
+#include "BindingUtility/NativeStreams.h"
+#include <nanobind/stl/filesystem.h>
+#include <cerrno>
+
+#ifdef JPH_PLATFORM_WINDOWS
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+void StreamOutFile::sThrowOpenError(const std::filesystem::path &inPath) {
+    if (errno == 0)
+        errno = ENOENT;
+    PyErr_SetFromErrnoWithFilename(PyExc_OSError, inPath.string().c_str());
+    throw nb::python_error();
+}
+
+bool StreamInMapped::Open(const std::filesystem::path &inPath) {
+    JPH_ASSERT(mData == nullptr && mSize == 0);
+    errno = 0;
+#ifdef JPH_PLATFORM_WINDOWS
+    HANDLE file = CreateFileW(inPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    mFile = file;
+    mSize = size_t(size.QuadPart);
+    if (mSize == 0)
+        return true;
+    mMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mMapping != nullptr)
+        mData = static_cast<const uint8 *>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+    if (mData == nullptr) {
+        if (mMapping != nullptr)
+            CloseHandle(mMapping);
+        CloseHandle(file);
+        mFile = nullptr;
+        mMapping = nullptr;
+        mSize = 0;
+        return false;
+    }
+#else
+    int fd = open(inPath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t size = size_t(info.st_size);
+    if (size > 0) {
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            int error = errno;
+            close(fd);
+            errno = error;
+            return false;
+        }
+        mData = static_cast<const uint8 *>(data);
+        mSize = size;
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+#endif
+    return true;
+}
+
+StreamInMapped::~StreamInMapped() {
+#ifdef JPH_PLATFORM_WINDOWS
+    if (mData != nullptr)
+        UnmapViewOfFile(mData);
+    if (mMapping != nullptr)
+        CloseHandle(mMapping);
+    if (mFile != nullptr)
+        CloseHandle(mFile);
+#else
+    if (mData != nullptr)
+        munmap(const_cast<uint8 *>(mData), mSize);
+#endif
+}
+
+void BindNativeStreams(nb::module_ &m) {
+    nb::class_<StreamOutFile, StreamOut>(m, "StreamOutFile",
+        "StreamOut that writes to a file with a large buffer without calling into Python")
+        .def(nb::init<const std::filesystem::path &, bool, size_t>(), "path"_a, "append"_a = false, "buffer_size"_a = StreamOutFile::cDefaultBufferSize,
+            "Args:\n"
+            "    path (str | os.PathLike): File to write, it is truncated unless append is True.\n"
+            "    append (bool): Append to an existing file.\n"
+            "    buffer_size (int): Size of the write buffer in bytes.")
+        .def("is_failed", &StreamOutFile::IsFailed)
+        .def("flush", &StreamOutFile::Flush, nb::call_guard<nb::gil_scoped_release>(),
+            "Write the buffered data to the file")
+        .def("close", &StreamOutFile::Close, nb::call_guard<nb::gil_scoped_release>(),
+            "Flush and close the file, the stream fails on further writes")
+        .def("__enter__", [](nb::handle self) { return self; })
+        .def("__exit__", [](StreamOutFile &self, nb::args) { self.Close(); });
+
+    nb::class_<StreamInFile, StreamIn>(m, "StreamInFile",
+        "StreamIn that reads from a file with a large buffer without calling into Python")
+        .def(nb::init<const std::filesystem::path &, size_t>(), "path"_a, "buffer_size"_a = StreamInFile::cDefaultBufferSize,
+            "Args:\n"
+            "    path (str | os.PathLike): File to read.\n"
+            "    buffer_size (int): Size of the read buffer in bytes.")
+        .def("is_eof", &StreamInFile::IsEOF)
+        .def("is_failed", &StreamInFile::IsFailed)
+        .def("close", &StreamInFile::Close)
+        .def("__enter__", [](nb::handle self) { return self; })
+        .def("__exit__", [](StreamInFile &self, nb::args) { self.Close(); });
+
+    nb::class_<StreamOutMemory, StreamOut>(m, "StreamOutMemory",
+        "StreamOut that writes to a growable contiguous block of memory")
+        .def(nb::init<>())
+        .def(nb::init<size_t>(), "reserve"_a,
+            "Args:\n"
+            "    reserve (int): Number of bytes to reserve up front.")
+        .def("is_failed", &StreamOutMemory::IsFailed)
+        .def("clear", [](StreamOutMemory &self) {
+            self.GetExports().ThrowIfExported();
+            self.Clear();
+        }, "Remove all data and the failed state, the capacity is kept for reuse. Raises BufferError while a view is alive.")
+        .def("get_size", [](const StreamOutMemory &self) { return self.GetData().size(); })
+        .def("get_view", [](nb::handle self) {
+            StreamOutMemory &stream = nb::cast<StreamOutMemory &>(self);
+            return stream.GetExports().MakeView(self, stream.GetData().data(), stream.GetData().size());
+        }, "Read-only memoryview of the data without copying. Like for a bytearray the data can't be resized while the view is alive,\n"
+            "writes fail the stream (see is_failed) until the view is released.")
+        .def("to_bytes", [](const StreamOutMemory &self) {
+            return nb::bytes(self.GetData().data(), self.GetData().size());
+        }, "Copy of the data")
+        .def("__len__", [](const StreamOutMemory &self) { return self.GetData().size(); });
+
+    nb::class_<StreamInMemory, StreamIn>(m, "StreamInMemory",
+        "StreamIn that reads from its own copy of a block of memory")
+        .def("__init__", [](StreamInMemory *self, nb::handle data) {
+            if (nb::isinstance<StreamOutMemory>(data)) {
+                const Array<uint8> &source = nb::cast<const StreamOutMemory &>(data).GetData();
+                new (self) StreamInMemory(source.data(), source.size());
+                return;
+            }
+            Py_buffer view;
+            if (PyObject_GetBuffer(data.ptr(), &view, PyBUF_C_CONTIGUOUS) != 0)
+                throw nb::python_error();
+            new (self) StreamInMemory(static_cast<const uint8 *>(view.buf), size_t(view.len));
+            PyBuffer_Release(&view);
+        }, "data"_a,
+            "Args:\n"
+            "    data (bytes-like | StreamOutMemory): Data to read, it is copied.")
+        .def("is_eof", &StreamInMemory::IsEOF)
+        .def("is_failed", &StreamInMemory::IsFailed)
+        .def("seek", &StreamInMemory::Seek, "position"_a,
+            "Move the read position, clears the EOF and failed state")
+        .def("tell", &StreamInMemory::Tell)
+        .def("get_size", [](const StreamInMemory &self) { return self.GetData().size(); })
+        .def("get_view", [](nb::handle self) {
+            const Array<uint8> &data = nb::cast<const StreamInMemory &>(self).GetData();
+            return MakeMemoryView(self, data.data(), data.size());
+        }, "Read-only memoryview of the data without copying");
+
+    nb::class_<StreamInMapped, StreamIn>(m, "StreamInMapped",
+        "Read-only StreamIn over a memory mapped file, the OS loads pages on first access")
+        .def("__init__", [](StreamInMapped *self, const std::filesystem::path &path) {
+            new (self) StreamInMapped();
+            bool opened;
+            {
+                nb::gil_scoped_release release;
+                opened = self->Open(path);
+            }
+            if (!opened) {
+                // Capture errno before the destructor can touch it
+                int error = errno;
+                self->~StreamInMapped();
+                errno = error;
+                StreamOutFile::sThrowOpenError(path);
+            }
+        }, "path"_a,
+            "Args:\n"
+            "    path (str | os.PathLike): File to map.")
+        .def("is_eof", &StreamInMapped::IsEOF)
+        .def("is_failed", &StreamInMapped::IsFailed)
+        .def("seek", &StreamInMapped::Seek, "position"_a,
+            "Move the read position, clears the EOF and failed state")
+        .def("tell", &StreamInMapped::Tell)
+        .def("get_size", &StreamInMapped::GetSize)
+        .def("get_view", [](nb::handle self) {
+            const StreamInMapped &stream = nb::cast<const StreamInMapped &>(self);
+            return MakeMemoryView(self, stream.GetData(), stream.GetSize());
+        }, "Read-only memoryview of the mapped file without copying");
+}
@@ -0,0 +1,326 @@
+#pragma once
+#include "Common.h"
+#include <Jolt/Core/StreamIn.h>
+#include <Jolt/Core/StreamOut.h>
+#include "BindingUtility/Stream.h"
+#include <nanobind/ndarray.h>
+#include <atomic>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+/// Read-only memoryview of inSize bytes at inData that keeps inOwner alive
+inline nb::object MakeMemoryView(nb::handle inOwner, const uint8 *inData, size_t inSize) {
+    nb::ndarray<nb::numpy, const uint8, nb::ndim<1>> array(inData, { inSize }, inOwner);
+    nb::object numpy_array = nb::cast(array);
+    return nb::steal(PyMemoryView_FromObject(numpy_array.ptr()));
+}
+
+/// Counts the memoryviews that are handed out on a buffer. Like bytearray, the owner of the buffer refuses to move or resize it while it is exported.
+class BufferExports {
+  public:
+    inline bool IsExported() const {
+        return mNumExports.load(std::memory_order_acquire) != 0;
+    }
+
+    /// Raise BufferError when a view is alive, call before an operation that can reallocate the buffer
+    inline void ThrowIfExported() const {
+        if (IsExported())
+            throw nb::buffer_error("Existing exports of data: object cannot be re-sized");
+    }
+
+    /// Read-only memoryview of inSize bytes at inData that keeps inOwner alive and counts as an export until it is released
+    nb::object MakeView(nb::handle inOwner, const uint8 *inData, size_t inSize) {
+        struct Export {
+            BufferExports *mExports;
+            PyObject *mOwner;
+        };
+        mNumExports.fetch_add(1, std::memory_order_acq_rel);
+        nb::capsule release(new Export { this, inOwner.inc_ref().ptr() }, [](void *inExport) noexcept {
+            Export *e = static_cast<Export *>(inExport);
+            e->mExports->mNumExports.fetch_sub(1, std::memory_order_acq_rel);
+            Py_DECREF(e->mOwner);
+            delete e;
+        });
+        return MakeMemoryView(release, inData, inSize);
+    }
+
+  private:
+    std::atomic<uint32> mNumExports = 0;
+};
+
+/// Buffered StreamOut to a file, no Python is involved while writing
+class StreamOutFile : public StreamOut {
+  public:
+    static constexpr size_t cDefaultBufferSize = 1024 * 1024;
+
+    StreamOutFile(const std::filesystem::path &inPath, bool inAppend = false, size_t inBufferSize = cDefaultBufferSize) :
+        mBuffer(std::make_unique<char[]>(inBufferSize)) {
+        mStream.rdbuf()->pubsetbuf(mBuffer.get(), std::streamsize(inBufferSize));
+        errno = 0;
+        mStream.open(inPath, std::ios::binary | std::ios::out | (inAppend ? std::ios::app : std::ios::trunc));
+        if (!mStream.is_open())
+            sThrowOpenError(inPath);
+    }
+
+    virtual void WriteBytes(const void *inData, size_t inNumBytes) override {
+        mStream.write(static_cast<const char *>(inData), std::streamsize(inNumBytes));
+    }
+
+    virtual bool IsFailed() const override {
+        return mStream.fail();
+    }
+
+    void Flush() {
+        mStream.flush();
+    }
+
+    void Close() {
+        if (mStream.is_open())
+            mStream.close();
+    }
+
+    /// Raise the OSError (e.g. FileNotFoundError) that matches errno for inPath
+    static void sThrowOpenError(const std::filesystem::path &inPath);
+
+  private:
+    std::unique_ptr<char[]> mBuffer;
+    std::ofstream mStream;
+};
+
+/// Buffered StreamIn from a file, no Python is involved while reading
+class StreamInFile : public StreamIn {
+  public:
+    static constexpr size_t cDefaultBufferSize = 1024 * 1024;
+
+    StreamInFile(const std::filesystem::path &inPath, size_t inBufferSize = cDefaultBufferSize) :
+        mBuffer(std::make_unique<char[]>(inBufferSize)) {
+        mStream.rdbuf()->pubsetbuf(mBuffer.get(), std::streamsize(inBufferSize));
+        errno = 0;
+        mStream.open(inPath, std::ios::binary | std::ios::in);
+        if (!mStream.is_open())
+            StreamOutFile::sThrowOpenError(inPath);
+    }
+
+    virtual void ReadBytes(void *outData, size_t inNumBytes) override {
+        mStream.read(static_cast<char *>(outData), std::streamsize(inNumBytes));
+    }
+
+    virtual bool IsEOF() const override {
+        return mStream.eof();
+    }
+
+    virtual bool IsFailed() const override {
+        return mStream.fail();
+    }
+
+    void Close() {
+        if (mStream.is_open())
+            mStream.close();
+    }
+
+  private:
+    std::unique_ptr<char[]> mBuffer;
+    std::ifstream mStream;
+};
+
+/// StreamOut to a growable contiguous block of memory
+class StreamOutMemory : public StreamOut {
+  public:
+    StreamOutMemory() = default;
+
+    explicit StreamOutMemory(size_t inReserve) {
+        mData.reserve(inReserve);
+    }
+
+    /// Fails the stream while a view on the data is exported, growing the buffer would free the memory behind the view
+    virtual void WriteBytes(const void *inData, size_t inNumBytes) override {
+        if (mExports.IsExported()) {
+            mFailed = true;
+            return;
+        }
+        const uint8 *data = static_cast<const uint8 *>(inData);
+        mData.insert(mData.end(), data, data + inNumBytes);
+    }
+
+    virtual bool IsFailed() const override {
+        return mFailed;
+    }
+
+    void Clear() {
+        mData.clear();
+        mFailed = false;
+    }
+
+    const Array<uint8> &GetData() const {
+        return mData;
+    }
+
+    BufferExports &GetExports() {
+        return mExports;
+    }
+
+  private:
+    Array<uint8> mData;
+    BufferExports mExports;
+    bool mFailed = false;
+};
+
+/// StreamIn from a block of memory owned by the stream
+class StreamInMemory : public StreamIn {
+  public:
+    StreamInMemory(const uint8 *inData, size_t inSize) :
+        mData(inData, inData + inSize) {
+    }
+
+    virtual void ReadBytes(void *outData, size_t inNumBytes) override {
+        if (mFailed)
+            return;
+        if (inNumBytes > mData.size() - mPosition) {
+            mEOF = mFailed = true;
+            return;
+        }
+        memcpy(outData, mData.data() + mPosition, inNumBytes);
+        mPosition += inNumBytes;
+    }
+
+    virtual bool IsEOF() const override {
+        return mEOF;
+    }
+
+    virtual bool IsFailed() const override {
+        return mFailed;
+    }
+
+    /// Move the read position, clears the error state
+    void Seek(size_t inPosition) {
+        mPosition = min(inPosition, mData.size());
+        mEOF = mFailed = false;
+    }
+
+    size_t Tell() const {
+        return mPosition;
+    }
+
+    const Array<uint8> &GetData() const {
+        return mData;
+    }
+
+  private:
+    Array<uint8> mData;
+    size_t mPosition = 0;
+    bool mEOF = false;
+    bool mFailed = false;
+};
+
+/// Read-only StreamIn over a memory mapped file, pages are loaded by the OS on first access
+class StreamInMapped : public StreamIn {
+  public:
+    StreamInMapped() = default;
+
+    /// Map a file, returns false (with errno set where the OS provides it) instead of throwing so it can be called without the GIL
+    bool Open(const std::filesystem::path &inPath);
+
+    virtual ~StreamInMapped() override;
+
+    virtual void ReadBytes(void *outData, size_t inNumBytes) override {
+        if (mFailed)
+            return;
+        if (inNumBytes > mSize - mPosition) {
+            mEOF = mFailed = true;
+            return;
+        }
+        memcpy(outData, mData + mPosition, inNumBytes);
+        mPosition += inNumBytes;
+    }
+
+    virtual bool IsEOF() const override {
+        return mEOF;
+    }
+
+    virtual bool IsFailed() const override {
+        return mFailed;
+    }
+
+    /// Move the read position, clears the error state
+    void Seek(size_t inPosition) {
+        mPosition = min(inPosition, mSize);
+        mEOF = mFailed = false;
+    }
+
+    size_t Tell() const {
+        return mPosition;
+    }
+
+    const uint8 *GetData() const {
+        return mData;
+    }
+
+    size_t GetSize() const {
+        return mSize;
+    }
+
+  private:
+    const uint8 *mData = nullptr;
+    size_t mSize = 0;
+    size_t mPosition = 0;
+    bool mEOF = false;
+    bool mFailed = false;
+#ifdef JPH_PLATFORM_WINDOWS
+    void *mFile = nullptr;
+    void *mMapping = nullptr;
+#endif
+};
+
+/// Use inObject directly if it is a StreamOut, otherwise wrap it in a PythonStreamOut. Construct and destroy with the GIL held.
+class StreamOutArg {
+  public:
+    /// Users of StreamOutArg call Flush when done, so the adapter can buffer
+    static constexpr size_t cAdapterBufferSize = 64 * 1024;
+
+    explicit StreamOutArg(nb::handle inObject) {
+        if (nb::isinstance<StreamOut>(inObject))
+            mStream = nb::cast<StreamOut *>(inObject);
+        else {
+            mAdapter = std::make_unique<PythonStreamOut>(nb::borrow<nb::object>(inObject), cAdapterBufferSize);
+            mStream = mAdapter.get();
+        }
+    }
+
+    StreamOut &Get() {
+        return *mStream;
+    }
+
+    /// Write out buffered data, returns false if the stream failed
+    bool Flush() {
+        if (mAdapter != nullptr)
+            return mAdapter->Flush();
+        return !mStream->IsFailed();
+    }
+
+  private:
+    StreamOut *mStream = nullptr;
+    std::unique_ptr<PythonStreamOut> mAdapter;
+};
+
+/// Use inObject directly if it is a StreamIn, otherwise wrap it in a PythonStreamIn. Construct and destroy with the GIL held.
+class StreamInArg {
+  public:
+    explicit StreamInArg(nb::handle inObject) {
+        if (nb::isinstance<StreamIn>(inObject))
+            mStream = nb::cast<StreamIn *>(inObject);
+        else {
+            mAdapter = std::make_unique<PythonStreamIn>(nb::borrow<nb::object>(inObject));
+            mStream = mAdapter.get();
+        }
+    }
+
+    StreamIn &Get() {
+        return *mStream;
+    }
+
+  private:
+    StreamIn *mStream = nullptr;
+    std::unique_ptr<PythonStreamIn> mAdapter;
+};
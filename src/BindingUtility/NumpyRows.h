@@ -0,0 +1,148 @@
+#pragma once
+#include "Common.h"
+#include <nanobind/ndarray.h>
+#include <limits>
+
+/// 1D array of body IDs (BodyID::GetIndexAndSequenceNumber values)
+using NumpyBodyIDs = nb::ndarray<nb::numpy, const uint32, nb::shape<-1>, nb::device::cpu, nb::c_contig>;
+
+/// (N, Cols) array of float32 or float64, the dtype is resolved at runtime
+template <int Cols>
+using NumpyRows = nb::ndarray<nb::numpy, nb::shape<-1, Cols>, nb::device::cpu, nb::c_contig>;
+
+static_assert(sizeof(BodyID) == sizeof(uint32), "Body ID arrays are reinterpreted as BodyID *");
+
+inline const BodyID *ToBodyIDs(const NumpyBodyIDs &inIDs) {
+    return reinterpret_cast<const BodyID *>(inIDs.data());
+}
+
+/// Typed access to the rows of a float32 / float64 NumpyRows array.
+/// An invalid (None) array results in a disabled channel.
+template <int Cols, bool Writable>
+class NumpyRowAccess {
+  public:
+    NumpyRowAccess() = default;
+
+    NumpyRowAccess(const NumpyRows<Cols> &inArray, size_t inNumRows, const char *inName) {
+        if (!inArray.is_valid())
+            return;
+
+        if (inArray.shape(0) != inNumRows)
+            throw nb::value_error((std::string(inName) + ": expected " + std::to_string(inNumRows) + " rows, got " + std::to_string(inArray.shape(0))).c_str());
+
+        if (inArray.dtype() == nb::dtype<float>())
+            mFloat = static_cast<float *>(const_cast<void *>(static_cast<const void *>(inArray.data())));
+        else if (inArray.dtype() == nb::dtype<double>())
+            mDouble = static_cast<double *>(const_cast<void *>(static_cast<const void *>(inArray.data())));
+        else
+            throw nb::type_error((std::string(inName) + ": dtype must be float32 or float64").c_str());
+    }
+
+    /// If this channel was requested
+    inline bool IsEnabled() const {
+        return mFloat != nullptr || mDouble != nullptr;
+    }
+
+    /// Store a Vec3, DVec3 (3 columns) or Quat (4 columns) in row inRow
+    template <class V>
+    inline void Store(size_t inRow, const V &inValue) const {
+        static_assert(Writable);
+        if (mFloat != nullptr)
+            StoreRow(mFloat + inRow * Cols, inValue);
+        else
+            StoreRow(mDouble + inRow * Cols, inValue);
+    }
+
+    /// Fill row inRow with NaN, used for bodies that could not be locked
+    inline void StoreNaN(size_t inRow) const {
+        static_assert(Writable);
+        for (int c = 0; c < Cols; ++c) {
+            if (mFloat != nullptr)
+                mFloat[inRow * Cols + c] = std::numeric_limits<float>::quiet_NaN();
+            else
+                mDouble[inRow * Cols + c] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    inline Vec3 LoadVec3(size_t inRow) const {
+        static_assert(Cols == 3);
+        if (mFloat != nullptr)
+            return Vec3(mFloat[inRow * 3], mFloat[inRow * 3 + 1], mFloat[inRow * 3 + 2]);
+        const double *d = mDouble + inRow * 3;
+        return Vec3(float(d[0]), float(d[1]), float(d[2]));
+    }
+
+    inline RVec3 LoadRVec3(size_t inRow) const {
+        static_assert(Cols == 3);
+        if (mDouble != nullptr) {
+            const double *d = mDouble + inRow * 3;
+            return RVec3(Real(d[0]), Real(d[1]), Real(d[2]));
+        }
+        return RVec3(LoadVec3(inRow));
+    }
+
+    inline Quat LoadQuat(size_t inRow) const {
+        static_assert(Cols == 4);
+        if (mFloat != nullptr)
+            return Quat(mFloat[inRow * 4], mFloat[inRow * 4 + 1], mFloat[inRow * 4 + 2], mFloat[inRow * 4 + 3]);
+        const double *d = mDouble + inRow * 4;
+        return Quat(float(d[0]), float(d[1]), float(d[2]), float(d[3]));
+    }
+
+  private:
+    template <class T, class V>
+    static inline void StoreRow(T *outRow, const V &inValue) {
+        outRow[0] = T(inValue.GetX());
+        outRow[1] = T(inValue.GetY());
+        outRow[2] = T(inValue.GetZ());
+        if constexpr (Cols == 4)
+            outRow[3] = T(inValue.GetW());
+    }
+
+    float *mFloat = nullptr;
+    double *mDouble = nullptr;
+};
+
+/// Allocate an uninitialized NumPy array that owns its memory, requires the GIL
+template <class T>
+nb::ndarray<nb::numpy, T> AllocateNumpyArray(std::initializer_list<size_t> inShape) {
+    size_t count = 1;
+    for (size_t s : inShape)
+        count *= s;
+    T *data = new T[max(count, size_t(1))];
+    nb::capsule owner(data, [](void *p) noexcept { delete[] static_cast<T *>(p); });
+    return nb::ndarray<nb::numpy, T>(data, inShape.size(), inShape.begin(), owner);
+}
+
+/// Convert an optional output argument to NumpyRows, None results in an invalid array (disabled channel).
+/// NumpyRows has no scalar type so nb::ndarray doesn't check if the array is writable, read-only arrays are rejected here. Requires the GIL.
+template <int Cols>
+NumpyRows<Cols> ToOutputRows(nb::handle inArray, const char *inName) {
+    NumpyRows<Cols> rows;
+    if (inArray.is_none())
+        return rows;
+
+    bool writable;
+    if (nb::hasattr(inArray, "flags"))
+        writable = nb::cast<bool>(inArray.attr("flags").attr("writeable"));
+    else {
+        Py_buffer view;
+        writable = PyObject_GetBuffer(inArray.ptr(), &view, PyBUF_WRITABLE) == 0;
+        if (writable)
+            PyBuffer_Release(&view);
+        else
+            PyErr_Clear();
+    }
+    if (!writable)
+        throw nb::value_error((std::string(inName) + ": array is read-only").c_str());
+
+    if (!nb::try_cast(inArray, rows, false))
+        throw nb::type_error((std::string(inName) + ": expected a C-contiguous (N, " + std::to_string(Cols) + ") float32 or float64 array").c_str());
+    return rows;
+}
+
+template <int Cols>
+using NumpyRowWriter = NumpyRowAccess<Cols, true>;
+
+template <int Cols>
+using NumpyRowReader = NumpyRowAccess<Cols, false>;
@@ -0,0 +1,35 @@
+#pragma once
+#include "Common.h"
+#include <Jolt/Core/JobSystem.h>
+#include <Jolt/Core/Color.h>
+
+/// Split [0, inCount) in batches of inBatchSize and call inFunction(begin, end) for every batch.
+/// The batches are distributed over the jobs of inJobSystem (if not null), the calling thread helps out while waiting.
+/// Must be called without holding the GIL if inFunction can block on it.
+template <class Function>
+void ParallelFor(JobSystem *inJobSystem, size_t inCount, size_t inBatchSize, const Function &inFunction) {
+    if (inCount == 0)
+        return;
+
+    size_t num_batches = (inCount + inBatchSize - 1) / inBatchSize;
+    size_t num_jobs = inJobSystem != nullptr ? min(num_batches, (size_t)inJobSystem->GetMaxConcurrency()) : 1;
+    if (num_jobs <= 1) {
+        inFunction(size_t(0), inCount);
+        return;
+    }
+
+    // Every job keeps pulling batches until all are done, this balances uneven batches
+    atomic<size_t> next_batch = 0;
+    auto job = [&]() {
+        for (size_t batch = next_batch.fetch_add(1, memory_order_relaxed); batch < num_batches; batch = next_batch.fetch_add(1, memory_order_relaxed)) {
+            size_t begin = batch * inBatchSize;
+            inFunction(begin, min(begin + inBatchSize, inCount));
+        }
+    };
+
+    JobSystem::Barrier *barrier = inJobSystem->CreateBarrier();
+    for (size_t i = 0; i < num_jobs; ++i)
+        barrier->AddJob(inJobSystem->CreateJob("ParallelFor", Color::sGreen, job));
+    inJobSystem->WaitForJobs(barrier);
+    inJobSystem->DestroyBarrier(barrier);
+}
@@ -0,0 +1,28 @@
+#include "Common.h"
+#include "BindingUtility/ParallelKernels.h"
+
+void BindParallelKernels(nb::module_ &m) {
+    nb::class_<ParallelKernel>(m, "ParallelKernel",
+        "Native kernel for JobSystemThreadPool.parallel_for, runs on the worker threads without the GIL.\n"
+        "The kernel keeps its arrays alive, don't resize or free them while parallel_for runs.")
+        .def("get_count", &ParallelKernel::GetCount,
+            "Number of elements the kernel processes");
+
+    nb::class_<TransformPointsKernel, ParallelKernel>(m, "TransformPointsKernel",
+        "out[i] = matrix * points[i]")
+        .def(nb::init<Mat44Arg, const NumpyRows<3> &, const NumpyRows<3> &, bool>(), "matrix"_a, "points"_a, "out"_a, "directions"_a = false,
+            "Args:\n"
+            "    matrix (Mat44): Transform to apply.\n"
+            "    points (ndarray): (N, 3) float32 or float64 array with the input points.\n"
+            "    out (ndarray): (N, 3) float32 or float64 array that receives the result, can be the same array as points.\n"
+            "    directions (bool): Only apply the 3x3 part of the matrix (for directions and normals).");
+
+    nb::class_<AxpyKernel, ParallelKernel>(m, "AxpyKernel",
+        "out[i] = a * x[i] + y[i] over all elements, e.g. integrating velocities or forces")
+        .def(nb::init<double, const AxpyKernel::NumpyAny &, const AxpyKernel::NumpyAny &, const AxpyKernel::NumpyAny &>(), "a"_a, "x"_a, "y"_a, "out"_a,
+            "Args:\n"
+            "    a (float): Scale of x.\n"
+            "    x (ndarray): Contiguous float32 or float64 array.\n"
+            "    y (ndarray): Array with the same dtype and number of elements as x.\n"
+            "    out (ndarray): Array with the same dtype and number of elements as x that receives the result, can be the same array as x or y.");
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "Common.h"
+#include "BindingUtility/NumpyRows.h"
+
+/// Native kernel for JobSystemThreadPool.parallel_for.
+/// Run is called for disjoint [begin, end) ranges from multiple threads at the same time, without holding the GIL.
+class ParallelKernel {
+  public:
+    virtual ~ParallelKernel() = default;
+
+    /// Number of elements the kernel processes
+    virtual size_t GetCount() const = 0;
+
+    virtual void Run(size_t inBegin, size_t inEnd) const = 0;
+};
+
+/// out[i] = matrix * points[i], or the 3x3 part of the matrix only for directions
+class TransformPointsKernel : public ParallelKernel {
+  public:
+    TransformPointsKernel(Mat44Arg inMatrix, const NumpyRows<3> &inPoints, const NumpyRows<3> &outPoints, bool inDirections) :
+        mMatrix(inMatrix),
+        mDirections(inDirections),
+        mPointsArray(inPoints),
+        mOutArray(outPoints),
+        mPoints(inPoints, inPoints.shape(0), "points"),
+        mOut(outPoints, inPoints.shape(0), "out") {
+    }
+
+    virtual size_t GetCount() const override {
+        return mPointsArray.shape(0);
+    }
+
+    virtual void Run(size_t inBegin, size_t inEnd) const override {
+        for (size_t i = inBegin; i < inEnd; ++i) {
+            Vec3 point = mPoints.LoadVec3(i);
+            mOut.Store(i, mDirections ? mMatrix.Multiply3x3(point) : mMatrix * point);
+        }
+    }
+
+  private:
+    Mat44 mMatrix;
+    bool mDirections;
+    NumpyRows<3> mPointsArray;
+    NumpyRows<3> mOutArray;
+    NumpyRowReader<3> mPoints;
+    NumpyRowWriter<3> mOut;
+};
+
+/// out[i] = a * x[i] + y[i] over all elements of equally sized float32 or float64 arrays, e.g. v += dt * a
+class AxpyKernel : public ParallelKernel {
+  public:
+    using NumpyAny = nb::ndarray<nb::numpy, nb::device::cpu, nb::c_contig>;
+
+    AxpyKernel(double inA, const NumpyAny &inX, const NumpyAny &inY, const NumpyAny &outArray) :
+        mA(inA),
+        mX(inX),
+        mY(inY),
+        mOut(outArray) {
+        if (inX.size() != inY.size() || inX.size() != outArray.size())
+            throw nb::value_error("x, y and out must have the same number of elements");
+        if (inX.dtype() != inY.dtype() || inX.dtype() != outArray.dtype())
+            throw nb::type_error("x, y and out must have the same dtype");
+        if (inX.dtype() != nb::dtype<float>() && inX.dtype() != nb::dtype<double>())
+            throw nb::type_error("dtype must be float32 or float64");
+    }
+
+    virtual size_t GetCount() const override {
+        return mX.size();
+    }
+
+    virtual void Run(size_t inBegin, size_t inEnd) const override {
+        if (mX.dtype() == nb::dtype<float>())
+            sRun(float(mA), static_cast<const float *>(mX.data()), static_cast<const float *>(mY.data()), static_cast<float *>(mOut.data()), inBegin, inEnd);
+        else
+            sRun(mA, static_cast<const double *>(mX.data()), static_cast<const double *>(mY.data()), static_cast<double *>(mOut.data()), inBegin, inEnd);
+    }
+
+  private:
+    template <class T>
+    static void sRun(T inA, const T *inX, const T *inY, T *outValues, size_t inBegin, size_t inEnd) {
+        for (size_t i = inBegin; i < inEnd; ++i)
+            outValues[i] = inA * inX[i] + inY[i];
+    }
+
+    double mA;
+    NumpyAny mX;
+    NumpyAny mY;
+    NumpyAny mOut;
+};
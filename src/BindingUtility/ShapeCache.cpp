@@ -0,0 +1,378 @@
+#include "Common.h"
+#include "BindingUtility/ShapeCache.h"
+#include "BindingUtility/NativeStreams.h"
+#include "BindingUtility/ShapeSettingsLock.h"
+#include <Jolt/Core/HashCombine.h>
+#include <Jolt/Physics/Collision/ObjectLayer.h>
+#ifdef JPH_OBJECT_STREAM
+    #include <Jolt/ObjectStream/ObjectStreamOut.h>
+#endif
+#include <nanobind/stl/filesystem.h>
+#include <nanobind/stl/string.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <thread>
+
+ShapeCache::ShapeCache(const std::filesystem::path &inDirectory) :
+    mDirectory(inDirectory) {
+    std::filesystem::create_directories(mDirectory);
+}
+
+bool ShapeCache::sCanHashSettings() {
+#ifdef JPH_OBJECT_STREAM
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64 ShapeCache::sHashSettings([[maybe_unused]] const ShapeSettings &inSettings) {
+#ifdef JPH_OBJECT_STREAM
+    // The binary object stream contains all attributes of the settings and of the settings and materials they reference
+    std::stringstream data;
+    if (!ObjectStreamOut::sWriteObject(data, ObjectStream::EStreamType::Binary, inSettings))
+        return 0;
+    std::string bytes = data.str();
+    return HashBytes(bytes.data(), uint(bytes.size()));
+#else
+    return 0;
+#endif
+}
+
+uint64 ShapeCache::sHashKey(const char *inKey, size_t inLength) {
+    return HashBytes(inKey, uint(inLength));
+}
+
+ShapeCache::Header ShapeCache::sMakeHeader(EKind inKind, uint64 inKey, uint64 inPayloadSize) {
+    Header header;
+    header.mMagic = uint32(inKind);
+    header.mFormatVersion = cFormatVersion;
+    header.mJoltVersion = (JPH_VERSION_MAJOR << 16) | (JPH_VERSION_MINOR << 8) | JPH_VERSION_PATCH;
+    header.mBuildFlags = uint32(sizeof(ObjectLayer)) << 8;
+#ifdef JPH_DOUBLE_PRECISION
+    header.mBuildFlags |= 1;
+#endif
+    header.mKey = inKey;
+    header.mPayloadSize = inPayloadSize;
+    return header;
+}
+
+std::filesystem::path ShapeCache::GetPath(EKind inKind, uint64 inKey) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx%s", static_cast<unsigned long long>(inKey), inKind == EKind::Shape ? ".jshape" : ".jscene");
+    return mDirectory / name;
+}
+
+/// Map the file for inKey and check its header, the stream is positioned at the payload on success
+static bool sOpenFile(StreamInMapped &ioStream, const std::filesystem::path &inPath, const ShapeCache::Header &inExpected) {
+    if (!ioStream.Open(inPath))
+        return false;
+
+    ShapeCache::Header header;
+    ioStream.Read(header);
+    return !ioStream.IsFailed()
+        && header.mMagic == inExpected.mMagic
+        && header.mFormatVersion == inExpected.mFormatVersion
+        && header.mJoltVersion == inExpected.mJoltVersion
+        && header.mBuildFlags == inExpected.mBuildFlags
+        && header.mKey == inExpected.mKey
+        && header.mPayloadSize == ioStream.GetSize() - sizeof(ShapeCache::Header);
+}
+
+bool ShapeCache::WriteFile(EKind inKind, uint64 inKey, const Array<uint8> &inPayload) {
+    std::filesystem::path path = GetPath(inKind, inKey);
+
+    // Write to a unique file and rename it over the final one, so other threads and processes never map a partial file
+    static std::atomic<uint64> sCounter = 0;
+    uint64 unique = uint64(std::chrono::steady_clock::now().time_since_epoch().count()) ^ (uint64(std::hash<std::thread::id>()(std::this_thread::get_id())) << 16) ^ sCounter++;
+    std::filesystem::path temp_path = path;
+    temp_path += ".tmp" + std::to_string(unique);
+
+    Header header = sMakeHeader(inKind, inKey, inPayload.size());
+    std::error_code error;
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(inPayload.data()), std::streamsize(inPayload.size()));
+        file.close();
+        if (file.fail()) {
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+
+    std::lock_guard lock(mMutex);
+    mStats.mBytesWritten += sizeof(header) + inPayload.size();
+    return true;
+}
+
+Ref<Shape> ShapeCache::ReadShapeFile(uint64 inKey) {
+    StreamInMapped stream;
+    if (!sOpenFile(stream, GetPath(EKind::Shape, inKey), sMakeHeader(EKind::Shape, inKey, 0)))
+        return nullptr;
+
+    Shape::IDToShapeMap shape_map;
+    Shape::IDToMaterialMap material_map;
+    Shape::ShapeResult result = Shape::sRestoreWithChildren(stream, shape_map, material_map);
+    if (result.HasError() || stream.IsFailed())
+        return nullptr;
+
+    std::lock_guard lock(mMutex);
+    ++mStats.mDiskHits;
+    mStats.mBytesMapped += stream.GetSize();
+
+    // Another thread may have restored the same key in the meantime, keep the first so the shape is shared
+    return mShapes.try_emplace(inKey, result.Get()).first->second;
+}
+
+ShapeSettings::ShapeResult ShapeCache::GetOrCreate(const ShapeSettings &inSettings, uint64 inKey) {
+    ShapeSettings::ShapeResult result;
+    {
+        std::lock_guard lock(mMutex);
+        UnorderedMap<uint64, Ref<Shape>>::const_iterator it = mShapes.find(inKey);
+        if (it != mShapes.end()) {
+            ++mStats.mMemoryHits;
+            result.Set(it->second);
+            return result;
+        }
+    }
+
+    Ref<Shape> shape = ReadShapeFile(inKey);
+    if (shape != nullptr) {
+        result.Set(shape);
+        return result;
+    }
+
+    result = ShapeSettingsLock::sCreate(inSettings);
+    if (result.HasError())
+        return result;
+
+    // A failure to write only costs a recook next time
+    StreamOutMemory stream;
+    Shape::ShapeToIDMap shape_map;
+    Shape::MaterialToIDMap material_map;
+    result.Get()->SaveWithChildren(stream, shape_map, material_map);
+    WriteFile(EKind::Shape, inKey, stream.GetData());
+
+    std::lock_guard lock(mMutex);
+    ++mStats.mMisses;
+    result.Set(mShapes.try_emplace(inKey, result.Get()).first->second);
+    return result;
+}
+
+bool ShapeCache::StoreShape(const Ref<Shape> &inShape, bool inHashContents, uint64 &ioKey) {
+    StreamOutMemory stream;
+    Shape::ShapeToIDMap shape_map;
+    Shape::MaterialToIDMap material_map;
+    inShape->SaveWithChildren(stream, shape_map, material_map);
+    if (inHashContents)
+        ioKey = HashBytes(stream.GetData().data(), uint(stream.GetData().size()));
+    if (!WriteFile(EKind::Shape, ioKey, stream.GetData()))
+        return false;
+
+    std::lock_guard lock(mMutex);
+    mShapes[ioKey] = inShape;
+    return true;
+}
+
+Ref<Shape> ShapeCache::LoadShape(uint64 inKey) {
+    {
+        std::lock_guard lock(mMutex);
+        UnorderedMap<uint64, Ref<Shape>>::const_iterator it = mShapes.find(inKey);
+        if (it != mShapes.end()) {
+            ++mStats.mMemoryHits;
+            return it->second;
+        }
+    }
+
+    Ref<Shape> shape = ReadShapeFile(inKey);
+    if (shape == nullptr) {
+        std::lock_guard lock(mMutex);
+        ++mStats.mMisses;
+    }
+    return shape;
+}
+
+bool ShapeCache::StoreScene(const PhysicsScene &inScene, bool inHashContents, uint64 &ioKey) {
+    StreamOutMemory stream;
+    inScene.SaveBinaryState(stream, true, true);
+    if (inHashContents)
+        ioKey = HashBytes(stream.GetData().data(), uint(stream.GetData().size()));
+    return WriteFile(EKind::Scene, ioKey, stream.GetData());
+}
+
+Ref<PhysicsScene> ShapeCache::LoadScene(uint64 inKey) {
+    StreamInMapped stream;
+    Ref<PhysicsScene> scene;
+    if (sOpenFile(stream, GetPath(EKind::Scene, inKey), sMakeHeader(EKind::Scene, inKey, 0))) {
+        PhysicsScene::PhysicsSceneResult result = PhysicsScene::sRestoreFromBinaryState(stream);
+        if (result.IsValid() && !stream.IsFailed())
+            scene = result.Get();
+    }
+
+    std::lock_guard lock(mMutex);
+    if (scene != nullptr) {
+        ++mStats.mDiskHits;
+        mStats.mBytesMapped += stream.GetSize();
+    } else
+        ++mStats.mMisses;
+    return scene;
+}
+
+bool ShapeCache::Contains(EKind inKind, uint64 inKey) const {
+    StreamInMapped stream;
+    return sOpenFile(stream, GetPath(inKind, inKey), sMakeHeader(inKind, inKey, 0));
+}
+
+bool ShapeCache::Remove(EKind inKind, uint64 inKey) {
+    if (inKind == EKind::Shape) {
+        std::lock_guard lock(mMutex);
+        mShapes.erase(inKey);
+    }
+    std::error_code error;
+    return std::filesystem::remove(GetPath(inKind, inKey), error);
+}
+
+void ShapeCache::ClearMemory() {
+    std::lock_guard lock(mMutex);
+    mShapes.clear();
+}
+
+ShapeCache::Stats ShapeCache::GetStats() const {
+    std::lock_guard lock(mMutex);
+    Stats stats = mStats;
+    stats.mNumShapesInMemory = uint64(mShapes.size());
+    return stats;
+}
+
+/// Keys are ints, or strings that are hashed
+static uint64 sToKey(nb::handle inKey) {
+    if (nb::isinstance<nb::str>(inKey)) {
+        Py_ssize_t length;
+        const char *key = PyUnicode_AsUTF8AndSize(inKey.ptr(), &length);
+        if (key == nullptr)
+            throw nb::python_error();
+        return ShapeCache::sHashKey(key, size_t(length));
+    }
+    return nb::cast<uint64>(inKey);
+}
+
+void BindShapeCache(nb::module_ &m) {
+    nb::class_<ShapeCache>(m, "ShapeCache",
+        "Directory of cooked shapes and scenes that are memory mapped when restored.\n"
+        "Files start with a versioned header, files written by another version of Jolt or pyjolt or by another build configuration are ignored and overwritten.\n"
+        "Restored shapes are kept in memory, so every lookup of a key returns the same shape. All methods release the GIL while cooking and doing IO.")
+        .def(nb::init<const std::filesystem::path &>(), "directory"_a,
+            "Args:\n"
+            "    directory (str | os.PathLike): Directory of the cache, it is created when it does not exist.")
+        .def("get_or_create", [](ShapeCache &self, const ShapeSettings &settings, nb::handle key) {
+            uint64 cache_key;
+            if (key.is_none()) {
+                if (!ShapeCache::sCanHashSettings())
+                    throw nb::value_error("key is required, this build does not include the object stream");
+                nb::gil_scoped_release release;
+                cache_key = ShapeCache::sHashSettings(settings);
+            } else
+                cache_key = sToKey(key);
+            if (cache_key == 0)
+                throw nb::value_error("settings could not be serialized, pass a key");
+
+            nb::gil_scoped_release release;
+            return self.GetOrCreate(settings, cache_key);
+        }, "settings"_a, "key"_a = nb::none(),
+            "Return the shape for the settings from memory or from disk, or create it and add it to the cache.\n"
+            "Args:\n"
+            "    settings (ShapeSettings): Settings of the shape.\n"
+            "    key (int | str, optional): Key of the shape, defaults to a hash of the serialized settings so identical settings share a file.\n"
+            "Returns:\n"
+            "    ShapeResult: The shape or the error of creating it.")
+        .def("store_shape", [](ShapeCache &self, Ref<Shape> shape, nb::handle key) {
+            uint64 cache_key = key.is_none() ? 0 : sToKey(key);
+            bool ok;
+            {
+                nb::gil_scoped_release release;
+                ok = self.StoreShape(shape, key.is_none(), cache_key);
+            }
+            if (!ok)
+                throw std::runtime_error("Failed to write to the shape cache");
+            return cache_key;
+        }, "shape"_a, "key"_a = nb::none(),
+            "Write a shape with its children and materials to the cache.\n"
+            "Args:\n"
+            "    shape (Shape): Shape to store.\n"
+            "    key (int | str, optional): Key of the shape, defaults to a hash of the cooked shape.\n"
+            "Returns:\n"
+            "    int: The key, pass it to load_shape.")
+        .def("load_shape", [](ShapeCache &self, nb::handle key) {
+            uint64 cache_key = sToKey(key);
+            nb::gil_scoped_release release;
+            return self.LoadShape(cache_key);
+        }, "key"_a,
+            "Returns:\n"
+            "    Shape | None: The cached shape or None when the key is not in the cache.")
+        .def("store_scene", [](ShapeCache &self, const PhysicsScene &scene, nb::handle key) {
+            uint64 cache_key = key.is_none() ? 0 : sToKey(key);
+            bool ok;
+            {
+                nb::gil_scoped_release release;
+                ok = self.StoreScene(scene, key.is_none(), cache_key);
+            }
+            if (!ok)
+                throw std::runtime_error("Failed to write to the shape cache");
+            return cache_key;
+        }, "scene"_a, "key"_a = nb::none(),
+            "Write a scene with its shapes and group filters to the cache.\n"
+            "Args:\n"
+            "    scene (PhysicsScene): Scene to store.\n"
+            "    key (int | str, optional): Key of the scene, defaults to a hash of the cooked scene.\n"
+            "Returns:\n"
+            "    int: The key, pass it to load_scene.")
+        .def("load_scene", [](ShapeCache &self, nb::handle key) {
+            uint64 cache_key = sToKey(key);
+            nb::gil_scoped_release release;
+            return self.LoadScene(cache_key);
+        }, "key"_a,
+            "Returns:\n"
+            "    PhysicsScene | None: A new copy of the cached scene or None when the key is not in the cache.")
+        .def("has_shape", [](const ShapeCache &self, nb::handle key) {
+            return self.Contains(ShapeCache::EKind::Shape, sToKey(key));
+        }, "key"_a)
+        .def("has_scene", [](const ShapeCache &self, nb::handle key) {
+            return self.Contains(ShapeCache::EKind::Scene, sToKey(key));
+        }, "key"_a)
+        .def("remove_shape", [](ShapeCache &self, nb::handle key) {
+            return self.Remove(ShapeCache::EKind::Shape, sToKey(key));
+        }, "key"_a, "Remove a shape from the cache, returns False when there was no file")
+        .def("remove_scene", [](ShapeCache &self, nb::handle key) {
+            return self.Remove(ShapeCache::EKind::Scene, sToKey(key));
+        }, "key"_a, "Remove a scene from the cache, returns False when there was no file")
+        .def("clear_memory", &ShapeCache::ClearMemory,
+            "Release the shapes that are kept in memory, the files are kept")
+        .def("get_directory", &ShapeCache::GetDirectory)
+        .def("get_stats", [](const ShapeCache &self) {
+            ShapeCache::Stats stats = self.GetStats();
+            nb::dict result;
+            result["memory_hits"] = stats.mMemoryHits;
+            result["disk_hits"] = stats.mDiskHits;
+            result["misses"] = stats.mMisses;
+            result["bytes_written"] = stats.mBytesWritten;
+            result["bytes_mapped"] = stats.mBytesMapped;
+            result["num_shapes_in_memory"] = stats.mNumShapesInMemory;
+            return result;
+        }, "Counters of the cache as a dict")
+        .def_static("hash_settings", [](const ShapeSettings &settings) {
+            if (!ShapeCache::sCanHashSettings())
+                throw nb::value_error("This build does not include the object stream");
+            nb::gil_scoped_release release;
+            return ShapeCache::sHashSettings(settings);
+        }, "settings"_a,
+            "Key that get_or_create uses for the settings, 0 when they could not be serialized");
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "Common.h"
+#include <Jolt/Physics/Collision/Shape/Shape.h>
+#include <Jolt/Physics/PhysicsScene.h>
+#include <Jolt/Core/UnorderedMap.h>
+#include <filesystem>
+#include <mutex>
+
+/// Directory of cooked shapes and scenes. Every file is a small versioned header followed by the data as written by
+/// Shape::SaveWithChildren or PhysicsScene::SaveBinaryState. Files are memory mapped when restored, and files of another
+/// format version, Jolt version or build configuration are treated as missing and overwritten.
+///
+/// Shapes that are created from settings are keyed on a 64 bit hash of the binary object stream of the settings, so identical
+/// inputs map to the same file. Restored shapes are kept in memory, so all users of a key share one shape tree.
+class ShapeCache {
+  public:
+    enum class EKind : uint32 {
+        Shape = 0x5048534a, // 'JSHP'
+        Scene = 0x4e43534a, // 'JSCN'
+    };
+
+    static constexpr uint32 cFormatVersion = 1;
+
+    struct Header {
+        uint32 mMagic;
+        uint32 mFormatVersion;
+        uint32 mJoltVersion;
+        uint32 mBuildFlags;
+        uint64 mKey;
+        uint64 mPayloadSize;
+    };
+    static_assert(sizeof(Header) == 32);
+
+    struct Stats {
+        uint64 mMemoryHits = 0;
+        uint64 mDiskHits = 0;
+        uint64 mMisses = 0;
+        uint64 mBytesWritten = 0;
+        uint64 mBytesMapped = 0;
+        uint64 mNumShapesInMemory = 0;
+    };
+
+    explicit ShapeCache(const std::filesystem::path &inDirectory);
+
+    /// Returns true when shapes can be keyed on their settings (requires JPH_OBJECT_STREAM)
+    static bool sCanHashSettings();
+
+    /// 64 bit hash of the settings and everything they reference, 0 if the settings could not be serialized
+    static uint64 sHashSettings(const ShapeSettings &inSettings);
+
+    /// Hash of a user supplied key string
+    static uint64 sHashKey(const char *inKey, size_t inLength);
+
+    /// Shape for the settings: from memory, from disk or created and written to disk
+    ShapeSettings::ShapeResult GetOrCreate(const ShapeSettings &inSettings, uint64 inKey);
+
+    /// Write a shape tree under ioKey and keep the shape in memory. When inHashContents is true ioKey is set to a hash of the cooked shape.
+    /// Returns false when the file could not be written.
+    bool StoreShape(const Ref<Shape> &inShape, bool inHashContents, uint64 &ioKey);
+
+    /// Shape for inKey or nullptr when it is not in the cache
+    Ref<Shape> LoadShape(uint64 inKey);
+
+    /// Write a scene with its shapes and group filters under ioKey. When inHashContents is true ioKey is set to a hash of the cooked scene.
+    /// Returns false when the file could not be written.
+    bool StoreScene(const PhysicsScene &inScene, bool inHashContents, uint64 &ioKey);
+
+    /// New copy of the scene for inKey or nullptr when it is not in the cache. Scenes are not kept in memory because they are mutable.
+    Ref<PhysicsScene> LoadScene(uint64 inKey);
+
+    /// Check if there is a valid file for inKey
+    bool Contains(EKind inKind, uint64 inKey) const;
+
+    /// Remove the file for inKey, and the shape from memory
+    bool Remove(EKind inKind, uint64 inKey);
+
+    /// Release the shapes that are kept in memory, the files are kept
+    void ClearMemory();
+
+    Stats GetStats() const;
+
+    const std::filesystem::path &GetDirectory() const {
+        return mDirectory;
+    }
+
+    std::filesystem::path GetPath(EKind inKind, uint64 inKey) const;
+
+  private:
+    static Header sMakeHeader(EKind inKind, uint64 inKey, uint64 inPayloadSize);
+
+    bool WriteFile(EKind inKind, uint64 inKey, const Array<uint8> &inPayload);
+
+    Ref<Shape> ReadShapeFile(uint64 inKey);
+
+    std::filesystem::path mDirectory;
+    mutable std::mutex mMutex;
+    UnorderedMap<uint64, Ref<Shape>> mShapes;
+    Stats mStats;
+};
@@ -0,0 +1,238 @@
+#include "Common.h"
+#include "BindingUtility/ShapeRegistry.h"
+#include "BindingUtility/ShapeCache.h"
+#include "BindingUtility/NativeStreams.h"
+#include "BindingUtility/MeshCooking.h"
+#include "BindingUtility/ShapeSettingsLock.h"
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
+#include <Jolt/Physics/Collision/Shape/CylinderShape.h>
+#include <Jolt/Physics/Collision/Shape/ConvexHullShape.h>
+#include <nanobind/stl/string.h>
+
+nb::object ShapeRegistry::Find(const Key &inKey) {
+    ++mStats.mLookups;
+
+    UnorderedMap<uint64, Entry>::iterator it = mEntries.find(inKey.GetHash());
+    if (it == mEntries.end())
+        return nb::object();
+
+    nb::object shape = it->second.mShape();
+    if (shape.is_none()) {
+        mEntries.erase(it);
+        return nb::object();
+    }
+
+    // Same hash for different parameters
+    if (it->second.mKeyBytes != inKey.GetBytes()) {
+        ++mStats.mCollisions;
+        return nb::object();
+    }
+
+    ++mStats.mHits;
+    mStats.mBytesSaved += it->second.mSizeBytes;
+    return shape;
+}
+
+nb::object ShapeRegistry::Insert(const Key &inKey, const Ref<Shape> &inShape) {
+    UnorderedMap<uint64, Entry>::iterator it = mEntries.find(inKey.GetHash());
+    if (it != mEntries.end()) {
+        nb::object existing = it->second.mShape();
+        if (!existing.is_none()) {
+            if (it->second.mKeyBytes == inKey.GetBytes())
+                return existing;
+
+            // The hash belongs to other parameters, hand out the shape without interning it
+            return nb::cast(inShape);
+        }
+        mEntries.erase(it);
+    }
+
+    // Dead entries are only found on lookup, so sweep them when the table has doubled since the last sweep
+    if (mEntries.size() >= 2 * max(mNumEntriesAfterPurge, size_t(64)))
+        Purge();
+
+    nb::object shape = nb::cast(inShape);
+    mEntries.try_emplace(inKey.GetHash(), Entry { nb::weakref(shape), sGetMemorySize(*inShape), inKey.GetBytes() });
+    return shape;
+}
+
+size_t ShapeRegistry::Purge() {
+    Array<uint64> dead;
+    for (const UnorderedMap<uint64, Entry>::value_type &entry : mEntries)
+        if (entry.second.mShape().is_none())
+            dead.push_back(entry.first);
+    for (uint64 key : dead)
+        mEntries.erase(key);
+
+    mNumEntriesAfterPurge = mEntries.size();
+    return dead.size();
+}
+
+uint64 ShapeRegistry::sGetMemorySize(const Shape &inShape) {
+    Shape::VisitedShapes visited;
+    return inShape.GetStatsRecursive(visited).mSizeBytes;
+}
+
+/// Return the interned shape for inKey, or create it with inCreate (called without the GIL) and intern it
+template <class CreateFunction>
+static nb::object sGetOrCreate(ShapeRegistry &ioRegistry, const ShapeRegistry::Key &inKey, const CreateFunction &inCreate) {
+    nb::object shape = ioRegistry.Find(inKey);
+    if (shape.is_valid())
+        return shape;
+
+    ShapeSettings::ShapeResult result;
+    {
+        nb::gil_scoped_release release;
+        result = inCreate();
+    }
+    if (result.HasError())
+        throw nb::value_error(result.GetError().c_str());
+    return ioRegistry.Insert(inKey, result.Get());
+}
+
+void BindShapeRegistry(nb::module_ &m) {
+    nb::class_<ShapeRegistry>(m, "ShapeRegistry",
+        "Opt-in interning of shapes: asking twice for the same geometry returns the same Shape, so bodies share it.\n"
+        "Shapes are keyed on a 64 bit hash of their parameters (materials by identity) and only weakly referenced, shapes that are no longer used are freed.\n"
+        "The parameters of primitives and convex hulls are stored and compared on every hit. Meshes, interned shapes and get_or_create rely on the hash alone.")
+        .def(nb::init<>())
+        .def("box", [](ShapeRegistry &self, Vec3Arg half_extent, float convex_radius, const PhysicsMaterial *material) {
+            ShapeRegistry::Key key(ShapeRegistry::EKeyType::Box);
+            key.Add(half_extent);
+            key.Add(convex_radius);
+            key.Add(material);
+            return sGetOrCreate(self, key, [&]() {
+                return BoxShapeSettings(half_extent, convex_radius, material).Create();
+            });
+        }, "half_extent"_a, "convex_radius"_a = cDefaultConvexRadius, "material"_a = nullptr,
+            "Interned BoxShape, see BoxShapeSettings for the arguments")
+        .def("sphere", [](ShapeRegistry &self, float radius, const PhysicsMaterial *material) {
+            ShapeRegistry::Key key(ShapeRegistry::EKeyType::Sphere);
+            key.Add(radius);
+            key.Add(material);
+            return sGetOrCreate(self, key, [&]() {
+                return SphereShapeSettings(radius, material).Create();
+            });
+        }, "radius"_a, "material"_a = nullptr,
+            "Interned SphereShape, see SphereShapeSettings for the arguments")
+        .def("capsule", [](ShapeRegistry &self, float half_height_of_cylinder, float radius, const PhysicsMaterial *material) {
+            ShapeRegistry::Key key(ShapeRegistry::EKeyType::Capsule);
+            key.Add(half_height_of_cylinder);
+            key.Add(radius);
+            key.Add(material);
+            return sGetOrCreate(self, key, [&]() {
+                return CapsuleShapeSettings(half_height_of_cylinder, radius, material).Create();
+            });
+        }, "half_height_of_cylinder"_a, "radius"_a, "material"_a = nullptr,
+            "Interned CapsuleShape, see CapsuleShapeSettings for the arguments")
+        .def("cylinder", [](ShapeRegistry &self, float half_height, float radius, float convex_radius, const PhysicsMaterial *material) {
+            ShapeRegistry::Key key(ShapeRegistry::EKeyType::Cylinder);
+            key.Add(half_height);
+            key.Add(radius);
+            key.Add(convex_radius);
+            key.Add(material);
+            return sGetOrCreate(self, key, [&]() {
+                return CylinderShapeSettings(half_height, radius, convex_radius, material).Create();
+            });
+        }, "half_height"_a, "radius"_a, "convex_radius"_a = cDefaultConvexRadius, "material"_a = nullptr,
+            "Interned CylinderShape, see CylinderShapeSettings for the arguments")
+        .def("convex_hull", [](ShapeRegistry &self, const NumpyRows<3> &points, float max_convex_radius, const PhysicsMaterial *material) {
+            size_t num_points = points.shape(0);
+            NumpyRowReader<3> reader(points, num_points, "points");
+            Array<Vec3> hull_points(num_points);
+            ShapeRegistry::Key key(ShapeRegistry::EKeyType::ConvexHull);
+            for (size_t i = 0; i < num_points; ++i) {
+                hull_points[i] = reader.LoadVec3(i);
+                key.Add(hull_points[i]);
+            }
+            key.Add(max_convex_radius);
+            key.Add(material);
+            return sGetOrCreate(self, key, [&]() {
+                return ConvexHullShapeSettings(hull_points, max_convex_radius, material).Create();
+            });
+        }, "points"_a, "max_convex_radius"_a = cDefaultConvexRadius, "material"_a = nullptr,
+            "Interned ConvexHullShape.\n"
+            "Args:\n"
+            "    points (ndarray): (N, 3) float32 or float64 array with the points of the hull, the order of the points is part of the key.\n"
+            "    max_convex_radius (float): Convex radius as in ConvexHullShapeSettings.\n"
+            "    material (PhysicsMaterial, optional): Material of the shape.")
+        .def("mesh", [](ShapeRegistry &self, const NumpyRows<3> &vertices, const NumpyTriangles &triangles, JobSystem *job_system) {
+            size_t num_vertices = vertices.shape(0);
+            size_t num_triangles = triangles.shape(0);
+            NumpyRowReader<3> reader(vertices, num_vertices, "vertices");
+            Ref<MeshShapeSettings> settings = new MeshShapeSettings;
+            ShapeRegistry::Key key(ShapeRegistry::EKeyType::Mesh, false);
+            bool valid;
+            {
+                nb::gil_scoped_release release;
+                valid = FillMeshShapeSettings(*settings, reader, num_vertices, triangles.data(), num_triangles, nullptr, nullptr, job_system);
+                key.AddBytes(settings->mTriangleVertices.data(), num_vertices * sizeof(Float3));
+                key.Add(num_vertices);
+                key.AddBytes(triangles.data(), 3 * num_triangles * sizeof(uint32));
+            }
+            if (!valid)
+                throw nb::value_error("triangles: vertex index out of range");
+
+            return sGetOrCreate(self, key, [&]() {
+                SanitizeMeshParallel(*settings, job_system);
+                return settings->Create();
+            });
+        }, "vertices"_a, "triangles"_a, "job_system"_a.none() = nb::none(),
+            "Interned MeshShape, the vertex and index buffers are hashed so the same mesh is only cooked once.\n"
+            "Args:\n"
+            "    vertices (ndarray): (V, 3) float32 or float64 array with the vertices.\n"
+            "    triangles (ndarray): (T, 3) uint32 array with the vertex indices of the triangles.\n"
+            "    job_system (JobSystem, optional): Job system to convert and sanitize the mesh on.")
+        .def("get_or_create", [](ShapeRegistry &self, const ShapeSettings &settings) {
+            if (!ShapeCache::sCanHashSettings())
+                throw nb::value_error("This build does not include the object stream, use the typed methods or intern");
+            uint64 hash;
+            {
+                nb::gil_scoped_release release;
+                hash = ShapeCache::sHashSettings(settings);
+            }
+            if (hash == 0)
+                throw nb::value_error("settings could not be serialized");
+
+            ShapeRegistry::Key key(ShapeRegistry::EKeyType::Settings);
+            key.Add(hash);
+            return sGetOrCreate(self, key, [&]() {
+                return ShapeSettingsLock::sCreate(settings);
+            });
+        }, "settings"_a,
+            "Interned shape for any ShapeSettings, keyed on a hash of the serialized settings (the same key as ShapeCache.get_or_create)")
+        .def("intern", [](ShapeRegistry &self, Ref<Shape> shape) {
+            // Two shapes are equivalent when they cook to the same bytes
+            StreamOutMemory stream;
+            {
+                nb::gil_scoped_release release;
+                Shape::ShapeToIDMap shape_map;
+                Shape::MaterialToIDMap material_map;
+                shape->SaveWithChildren(stream, shape_map, material_map);
+            }
+            ShapeRegistry::Key key(ShapeRegistry::EKeyType::Cooked, false);
+            key.AddBytes(stream.GetData().data(), stream.GetData().size());
+
+            nb::object existing = self.Find(key);
+            return existing.is_valid() ? existing : self.Insert(key, shape);
+        }, "shape"_a,
+            "Return the registered shape that is equivalent to shape (same type, parameters and materials), or register shape and return it")
+        .def("purge", &ShapeRegistry::Purge,
+            "Remove the entries of freed shapes, returns the number of removed entries. Also done automatically as the registry grows.")
+        .def("clear", &ShapeRegistry::Clear,
+            "Forget all shapes, shapes that are in use stay alive")
+        .def("__len__", &ShapeRegistry::GetNumEntries)
+        .def("get_stats", [](const ShapeRegistry &self) {
+            const ShapeRegistry::Stats &stats = self.GetStats();
+            nb::dict result;
+            result["lookups"] = stats.mLookups;
+            result["hits"] = stats.mHits;
+            result["hit_rate"] = stats.mLookups > 0 ? double(stats.mHits) / double(stats.mLookups) : 0.0;
+            result["bytes_saved"] = stats.mBytesSaved;
+            result["collisions"] = stats.mCollisions;
+            result["num_entries"] = self.GetNumEntries();
+            return result;
+        }, "Lookups, hits, hit rate, the memory the hits saved (the size of the shapes that did not have to be created) and the number of detected hash collisions as a dict");
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "Common.h"
+#include <Jolt/Physics/Collision/Shape/Shape.h>
+#include <Jolt/Core/HashCombine.h>
+#include <Jolt/Core/UnorderedMap.h>
+
+/// Interns shapes by the parameters they were created from, so bodies with the same geometry share one Shape.
+/// Shapes are referenced through Python weak references, a shape that is no longer used anywhere is freed and its entry is purged.
+/// Every method must be called with the GIL held, the GIL protects the table.
+class ShapeRegistry {
+  public:
+    enum class EKeyType : uint32 {
+        Box,
+        Sphere,
+        Capsule,
+        Cylinder,
+        ConvexHull,
+        Mesh,
+        Settings,
+        Cooked,
+    };
+
+    /// Incremental FNV-1a hash of the type and the parameters of a shape. Unless inKeepBytes is false the hashed bytes are kept too,
+    /// so a lookup can tell a hash collision from a match. Keys of meshes and cooked shapes can be megabytes and only keep the hash.
+    class Key {
+      public:
+        explicit Key(EKeyType inType, bool inKeepBytes = true) :
+            mKeepBytes(inKeepBytes) {
+            Add(inType);
+        }
+
+        void AddBytes(const void *inData, size_t inSize) {
+            mHash = HashBytes(inData, uint(inSize), mHash);
+            mSize += inSize;
+            if (mKeepBytes)
+                mBytes.insert(mBytes.end(), static_cast<const uint8 *>(inData), static_cast<const uint8 *>(inData) + inSize);
+        }
+
+        template <class T>
+        void Add(const T &inValue) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            AddBytes(&inValue, sizeof(T));
+        }
+
+        void Add(Vec3Arg inValue) {
+            Add(Float3(inValue.GetX(), inValue.GetY(), inValue.GetZ()));
+        }
+
+        /// Materials are compared by identity
+        void Add(const PhysicsMaterial *inMaterial) {
+            Add(reinterpret_cast<uintptr_t>(inMaterial));
+        }
+
+        /// Hash with the number of hashed bytes folded in, to make collisions between inputs of different sizes even less likely
+        uint64 GetHash() const {
+            return HashBytes(&mSize, sizeof(mSize), mHash);
+        }
+
+        /// Hashed bytes, empty when they are not kept
+        const Array<uint8> &GetBytes() const {
+            return mBytes;
+        }
+
+      private:
+        uint64 mHash = 0xcbf29ce484222325UL;
+        uint64 mSize = 0;
+        bool mKeepBytes;
+        Array<uint8> mBytes;
+    };
+
+    struct Stats {
+        uint64 mLookups = 0;
+        uint64 mHits = 0;
+        uint64 mBytesSaved = 0;
+        uint64 mCollisions = 0;
+    };
+
+    /// Live shape for inKey or an invalid object. Counts a lookup, and a hit when found.
+    nb::object Find(const Key &inKey);
+
+    /// Add a newly created shape under inKey and return its Python object. When another live shape was added for the key
+    /// in the meantime (while the GIL was released to create this one), that shape is returned instead.
+    /// When the hash is taken by a live shape with different key bytes, inShape is returned without being registered.
+    nb::object Insert(const Key &inKey, const Ref<Shape> &inShape);
+
+    /// Remove the entries of shapes that have been freed, returns the number of removed entries
+    size_t Purge();
+
+    void Clear() {
+        mEntries.clear();
+        mNumEntriesAfterPurge = 0;
+    }
+
+    size_t GetNumEntries() const {
+        return mEntries.size();
+    }
+
+    const Stats &GetStats() const {
+        return mStats;
+    }
+
+    /// Number of bytes used by a shape and its children
+    static uint64 sGetMemorySize(const Shape &inShape);
+
+  private:
+    struct Entry {
+        nb::weakref mShape;
+        uint64 mSizeBytes;
+        Array<uint8> mKeyBytes;
+    };
+
+    UnorderedMap<uint64, Entry> mEntries;
+    size_t mNumEntriesAfterPurge = 0;
+    Stats mStats;
+};
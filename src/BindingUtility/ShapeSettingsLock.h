@@ -0,0 +1,30 @@
+#pragma once
+#include "Common.h"
+#include <Jolt/Physics/Collision/Shape/Shape.h>
+#include <mutex>
+
+/// ShapeSettings::Create caches its result in the settings without synchronization. The bindings create shapes without the GIL,
+/// so calls for the same settings from several Python threads are serialized on a lock that is picked by the address of the settings.
+/// Child settings that are shared by settings that are created at the same time are not covered.
+class ShapeSettingsLock {
+  public:
+    static constexpr uint cNumLocks = 64;
+
+    explicit ShapeSettingsLock(const ShapeSettings &inSettings) :
+        mLock(sGetMutex(inSettings)) {
+    }
+
+    /// Create the shape with the lock of inSettings held, call without the GIL
+    static ShapeSettings::ShapeResult sCreate(const ShapeSettings &inSettings) {
+        ShapeSettingsLock lock(inSettings);
+        return inSettings.Create();
+    }
+
+  private:
+    static std::mutex &sGetMutex(const ShapeSettings &inSettings) {
+        static std::mutex sMutexes[cNumLocks];
+        return sMutexes[(reinterpret_cast<uintptr_t>(&inSettings) / alignof(ShapeSettings)) % cNumLocks];
+    }
+
+    std::lock_guard<std::mutex> mLock;
+};
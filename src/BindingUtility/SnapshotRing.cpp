@@ -0,0 +1,133 @@
+#include "Common.h"
+#include "BindingUtility/SnapshotRing.h"
+#include "BindingUtility/NumpyRows.h"
+#include <nanobind/ndarray.h>
+#include <nanobind/stl/optional.h>
+#include <string>
+
+void BindSnapshotRing(nb::module_ &m) {
+    using NumpyInputs = nb::ndarray<nb::numpy, const float, nb::shape<-1, -1, 3>, nb::device::cpu, nb::c_contig>;
+
+    nb::class_<SnapshotRing>(m, "SnapshotRing",
+        "Ring of preallocated state snapshots indexed by tick, for rollback networking.\n"
+        "Save every tick, on a misprediction resimulate from the last confirmed tick with the corrected inputs.")
+        .def("__init__", [](SnapshotRing *self, PhysicsSystem &physics_system, uint capacity, EStateRecorderState state_flags, const StateRecorderFilter *filter, size_t reserve) {
+            if (capacity == 0)
+                throw nb::value_error("capacity must be larger than 0");
+            new (self) SnapshotRing(physics_system, capacity, state_flags, filter, reserve);
+        }, "physics_system"_a, "capacity"_a, "state_flags"_a = EStateRecorderState::All, "filter"_a = nullptr, "reserve"_a = 0,
+            nb::keep_alive<1, 2>(), nb::keep_alive<1, 5>(),
+            "Args:\n"
+            "    physics_system (PhysicsSystem): System to save and restore.\n"
+            "    capacity (int): Number of ticks that are kept.\n"
+            "    state_flags (EStateRecorderState): Which parts of the state to save.\n"
+            "    filter (StateRecorderFilter, optional): Filter that selects what to save and restore.\n"
+            "    reserve (int): Bytes to reserve per snapshot up front.")
+        .def("save", [](SnapshotRing &self, int64 tick) {
+            if (tick < 0)
+                throw nb::value_error("tick must not be negative");
+            nb::gil_scoped_release release;
+            self.Save(tick);
+        }, "tick"_a,
+            "Save the current state as tick, replacing the snapshot that is capacity ticks older")
+        .def("has_tick", &SnapshotRing::HasTick, "tick"_a,
+            "Check if the snapshot of tick is still in the ring")
+        .def("rewind", &SnapshotRing::Rewind, "tick"_a, nb::call_guard<nb::gil_scoped_release>(),
+            "Restore the state of tick.\n"
+            "Returns:\n"
+            "    bool: False if the tick is no longer in the ring or the state could not be restored.")
+        .def("resimulate", [](SnapshotRing &self, int64 from_tick, uint num_ticks, float delta_time, int collision_steps, TempAllocator *temp_allocator, JobSystem *job_system,
+                              std::optional<NumpyBodyIDs> body_ids, std::optional<NumpyInputs> forces, std::optional<NumpyInputs> linear_velocities,
+                              std::optional<NumpyInputs> angular_velocities, std::optional<nb::callable> inputs_callback) {
+            SnapshotRingInputs inputs;
+            if (body_ids) {
+                inputs.mBodyIDs = body_ids->data();
+                inputs.mNumBodies = body_ids->shape(0);
+            }
+            auto use_array = [&](const std::optional<NumpyInputs> &inArray, const char *inName) -> const float * {
+                if (!inArray)
+                    return nullptr;
+                if (!body_ids)
+                    throw nb::value_error("body_ids is required for array inputs");
+                if (inArray->shape(0) < num_ticks || inArray->shape(1) != inputs.mNumBodies)
+                    throw nb::value_error((std::string(inName) + " must have shape (num_ticks, len(body_ids), 3)").c_str());
+                return inArray->data();
+            };
+            inputs.mForces = use_array(forces, "forces");
+            inputs.mLinearVelocities = use_array(linear_velocities, "linear_velocities");
+            inputs.mAngularVelocities = use_array(angular_velocities, "angular_velocities");
+
+            std::function<void(uint)> apply_inputs;
+            if (inputs_callback)
+                apply_inputs = [&inputs_callback, from_tick](uint inIndex) {
+                    nb::gil_scoped_acquire gil;
+                    (*inputs_callback)(from_tick + inIndex);
+                };
+
+            nb::gil_scoped_release release;
+            if (!self.Rewind(from_tick))
+                throw nb::value_error("from_tick is not in the ring or could not be restored");
+            return self.Resimulate(from_tick, num_ticks, delta_time, collision_steps, temp_allocator, job_system, inputs, apply_inputs);
+        }, "from_tick"_a, "num_ticks"_a, "delta_time"_a, "collision_steps"_a, "temp_allocator"_a, "job_system"_a,
+            "body_ids"_a = nb::none(), "forces"_a = nb::none(), "linear_velocities"_a = nb::none(), "angular_velocities"_a = nb::none(),
+            "inputs_callback"_a = nb::none(),
+            "Rewind to from_tick and step num_ticks times without returning to Python, saving the state after every step as the next tick.\n"
+            "Args:\n"
+            "    from_tick (int): Last tick with a correct state.\n"
+            "    num_ticks (int): Number of ticks to simulate.\n"
+            "    delta_time (float): Time step per tick.\n"
+            "    collision_steps (int): Collision steps per tick.\n"
+            "    temp_allocator (TempAllocator): Allocator used during the update.\n"
+            "    job_system (JobSystem): Job system used during the update.\n"
+            "    body_ids (ndarray, optional): (M,) uint32 bodies that receive the array inputs.\n"
+            "    forces (ndarray, optional): (num_ticks, M, 3) float32 forces added before each tick.\n"
+            "    linear_velocities (ndarray, optional): (num_ticks, M, 3) float32 linear velocities set before each tick.\n"
+            "    angular_velocities (ndarray, optional): (num_ticks, M, 3) float32 angular velocities set before each tick.\n"
+            "    inputs_callback (callable, optional): Called with the tick that is about to be simulated (from_tick + i), for inputs arrays can't express.\n"
+            "Returns:\n"
+            "    EPhysicsUpdateError: Combined errors of all steps.")
+        .def("get_snapshot", [](const SnapshotRing &self, int64 tick) {
+            if (!self.HasTick(tick))
+                throw nb::value_error("tick is not in the ring");
+            const StateRecorderBuffer &recorder = self.GetSlot(tick).mRecorder;
+            return nb::bytes(recorder.GetReadData(), recorder.GetReadSize());
+        }, "tick"_a,
+            "Copy of the saved state of tick, e.g. to send it to a client. Slots are reused while saving, so no view is handed out.")
+        .def("get_capacity", &SnapshotRing::GetCapacity)
+        .def("get_latest_tick", &SnapshotRing::GetLatestTick,
+            "Most recent tick that was saved, or the tick that was rewound to. -1 if nothing was saved.")
+        .def("get_stats", [](const SnapshotRing &self) {
+            size_t num_valid = 0;
+            for (uint i = 0; i < self.GetCapacity(); ++i)
+                if (self.GetSlotAt(i).mTick >= 0)
+                    ++num_valid;
+
+            auto ticks = AllocateNumpyArray<int64>({ num_valid });
+            auto sizes = AllocateNumpyArray<uint64>({ num_valid });
+            auto save_times = AllocateNumpyArray<double>({ num_valid });
+            uint64 total_bytes = 0;
+            size_t index = 0;
+            for (uint i = 0; i < self.GetCapacity(); ++i) {
+                const SnapshotRing::Slot &slot = self.GetSlotAt(i);
+                if (slot.mTick < 0)
+                    continue;
+                ticks.data()[index] = slot.mTick;
+                sizes.data()[index] = slot.mRecorder.GetReadSize();
+                save_times.data()[index] = slot.mSaveTimeUs;
+                total_bytes += slot.mRecorder.GetData().capacity();
+                ++index;
+            }
+
+            nb::dict result;
+            result["ticks"] = ticks;
+            result["sizes"] = sizes;
+            result["save_time_us"] = save_times;
+            result["reserved_bytes"] = total_bytes;
+            result["rewind_time_us"] = self.GetRewindTimeUs();
+            result["resimulate_time_us"] = self.GetResimulateTimeUs();
+            return result;
+        },
+            "Statistics per saved snapshot (in ring order) and of the last rewind and resimulate.\n"
+            "Returns:\n"
+            "    dict: ticks (int64), sizes in bytes (uint64) and save_time_us (float64) arrays, reserved_bytes, rewind_time_us and resimulate_time_us.");
+}
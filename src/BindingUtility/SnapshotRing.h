@@ -0,0 +1,145 @@
+#pragma once
+#include "Common.h"
+#include "BindingUtility/StateRecorderBuffer.h"
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Core/JobSystem.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+/// Inputs that are applied to bodies before every tick while resimulating, all arrays are indexed [tick][body]
+struct SnapshotRingInputs {
+    const uint32 *mBodyIDs = nullptr;
+    size_t mNumBodies = 0;
+    const float *mForces = nullptr;
+    const float *mLinearVelocities = nullptr;
+    const float *mAngularVelocities = nullptr;
+};
+
+/// Fixed number of preallocated state snapshots indexed by tick, for rollback networking
+class SnapshotRing {
+  public:
+    struct Slot {
+        StateRecorderBuffer mRecorder;
+        int64 mTick = -1;
+        double mSaveTimeUs = 0.0;
+    };
+
+    SnapshotRing(PhysicsSystem &inSystem, uint inCapacity, EStateRecorderState inState, const StateRecorderFilter *inFilter, size_t inReserve) :
+        mSystem(inSystem),
+        mState(inState),
+        mFilter(inFilter),
+        mCapacity(inCapacity),
+        mSlots(std::make_unique<Slot[]>(inCapacity)) {
+        for (uint i = 0; i < mCapacity; ++i)
+            mSlots[i].mRecorder.Reserve(inReserve);
+    }
+
+    /// Save the current state of the system as inTick, overwrites the snapshot that was capacity ticks older
+    void Save(int64 inTick) {
+        auto start = std::chrono::steady_clock::now();
+
+        Slot &slot = GetSlot(inTick);
+        slot.mRecorder.Clear();
+        mSystem.SaveState(slot.mRecorder, mState, mFilter);
+        slot.mTick = inTick;
+
+        slot.mSaveTimeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        mLatestTick = max(mLatestTick, inTick);
+    }
+
+    bool HasTick(int64 inTick) const {
+        return inTick >= 0 && GetSlot(inTick).mTick == inTick;
+    }
+
+    /// Restore the state that was saved for inTick, returns false if it is no longer in the ring or could not be restored
+    bool Rewind(int64 inTick) {
+        if (!HasTick(inTick))
+            return false;
+
+        auto start = std::chrono::steady_clock::now();
+
+        Slot &slot = GetSlot(inTick);
+        slot.mRecorder.Rewind();
+        bool result = mSystem.RestoreState(slot.mRecorder, mFilter);
+
+        // Snapshots after the rewound tick are about to be replaced
+        mLatestTick = inTick;
+        mRewindTimeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    /// Rewind to inFromTick and step inNumTicks times, saving the state after every step as the following tick.
+    /// inApplyInputs is called before every step with the index of the step, after the array inputs were applied.
+    EPhysicsUpdateError Resimulate(int64 inFromTick, uint inNumTicks, float inDeltaTime, int inCollisionSteps, TempAllocator *inTempAllocator, JobSystem *inJobSystem,
+                                   const SnapshotRingInputs &inInputs, const std::function<void(uint)> &inApplyInputs) {
+        auto start = std::chrono::steady_clock::now();
+
+        EPhysicsUpdateError errors = EPhysicsUpdateError::None;
+        BodyInterface &body_interface = mSystem.GetBodyInterface();
+        for (uint i = 0; i < inNumTicks; ++i) {
+            for (size_t b = 0; b < inInputs.mNumBodies; ++b) {
+                BodyID id(inInputs.mBodyIDs[b]);
+                size_t offset = 3 * (i * inInputs.mNumBodies + b);
+                if (inInputs.mLinearVelocities != nullptr)
+                    body_interface.SetLinearVelocity(id, Vec3(*reinterpret_cast<const Float3 *>(inInputs.mLinearVelocities + offset)));
+                if (inInputs.mAngularVelocities != nullptr)
+                    body_interface.SetAngularVelocity(id, Vec3(*reinterpret_cast<const Float3 *>(inInputs.mAngularVelocities + offset)));
+                if (inInputs.mForces != nullptr)
+                    body_interface.AddForce(id, Vec3(*reinterpret_cast<const Float3 *>(inInputs.mForces + offset)));
+            }
+            if (inApplyInputs)
+                inApplyInputs(i);
+
+            errors |= mSystem.Update(inDeltaTime, inCollisionSteps, inTempAllocator, inJobSystem);
+            Save(inFromTick + i + 1);
+        }
+
+        mResimulateTimeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        return errors;
+    }
+
+    inline const Slot &GetSlot(int64 inTick) const {
+        return mSlots[size_t(inTick) % mCapacity];
+    }
+
+    inline Slot &GetSlot(int64 inTick) {
+        return mSlots[size_t(inTick) % mCapacity];
+    }
+
+    inline uint GetCapacity() const {
+        return mCapacity;
+    }
+
+    /// Slot by index in the ring
+    inline const Slot &GetSlotAt(uint inIndex) const {
+        return mSlots[inIndex];
+    }
+
+    inline const PhysicsSystem &GetSystem() const {
+        return mSystem;
+    }
+
+    inline int64 GetLatestTick() const {
+        return mLatestTick;
+    }
+
+    inline double GetRewindTimeUs() const {
+        return mRewindTimeUs;
+    }
+
+    inline double GetResimulateTimeUs() const {
+        return mResimulateTimeUs;
+    }
+
+  private:
+    PhysicsSystem &mSystem;
+    EStateRecorderState mState;
+    const StateRecorderFilter *mFilter;
+    uint mCapacity;
+    std::unique_ptr<Slot[]> mSlots;
+    int64 mLatestTick = -1;
+    double mRewindTimeUs = 0.0;
+    double mResimulateTimeUs = 0.0;
+};
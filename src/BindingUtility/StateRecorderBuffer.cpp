@@ -0,0 +1,50 @@
+#include "Common.h"
+#include "BindingUtility/StateRecorderBuffer.h"
+#include "BindingUtility/NativeStreams.h"
+
+void BindStateRecorderBuffer(nb::module_ &m) {
+    nb::class_<StateRecorderBuffer, StateRecorder>(m, "StateRecorderBuffer",
+        "StateRecorder backed by a reusable, cache line aligned byte buffer.\n"
+        "Call clear() before saving the next frame to reuse the memory, get_view() gives the data without copying.",
+        nb::is_final())
+        .def(nb::init<>())
+        .def(nb::init<size_t>(), "reserve"_a,
+            "Args:\n"
+            "    reserve (int): Number of bytes to reserve up front.")
+        .def("reserve", [](StateRecorderBuffer &self, size_t num_bytes) {
+            self.GetExports().ThrowIfExported();
+            self.Reserve(num_bytes);
+        }, "num_bytes"_a,
+            "Make sure the buffer can hold num_bytes without reallocating. Raises BufferError while a view is alive.")
+        .def("clear", [](StateRecorderBuffer &self) {
+            self.GetExports().ThrowIfExported();
+            self.Clear();
+        }, "Remove all data to record the next state, the capacity is kept. Raises BufferError while a view is alive.")
+        .def("rewind", &StateRecorderBuffer::Rewind,
+            "Start reading from the beginning, e.g. before PhysicsSystem.restore_state")
+        .def("set_data", [](StateRecorderBuffer &self, nb::handle data) {
+            self.GetExports().ThrowIfExported();
+            Py_buffer view;
+            if (PyObject_GetBuffer(data.ptr(), &view, PyBUF_C_CONTIGUOUS) != 0)
+                throw nb::python_error();
+            self.SetData(view.buf, size_t(view.len));
+            PyBuffer_Release(&view);
+        }, "data"_a,
+            "Replace the contents with a copy of a bytes-like object and rewind. Raises BufferError while a view is alive.")
+        .def("get_size", [](const StateRecorderBuffer &self) { return self.GetReadSize(); },
+            "Size of the recorded state in bytes")
+        .def("get_capacity", [](const StateRecorderBuffer &self) { return self.GetData().capacity(); })
+        .def("get_view", [](nb::handle self) {
+            StateRecorderBuffer &recorder = nb::cast<StateRecorderBuffer &>(self);
+            return recorder.GetExports().MakeView(self, recorder.GetReadData(), recorder.GetReadSize());
+        }, "Read-only memoryview of the recorded state without copying. Like for a bytearray the data can't be changed while the view is alive:\n"
+            "clear, reserve and set_data raise BufferError and saving a state fails the recorder (see is_failed). Release the view before the next frame.")
+        .def("to_bytes", [](const StateRecorderBuffer &self) {
+            return nb::bytes(self.GetReadData(), self.GetReadSize());
+        }, "Copy of the recorded state")
+        .def("is_eof", &StateRecorderBuffer::IsEOF)
+        .def("is_failed", &StateRecorderBuffer::IsFailed)
+        .def("get_num_mismatches", &StateRecorderBuffer::GetNumMismatches,
+            "Number of reads in validation mode where the current state differed from the recorded state since the last rewind")
+        .def("__len__", [](const StateRecorderBuffer &self) { return self.GetReadSize(); });
+}
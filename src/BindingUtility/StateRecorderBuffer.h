@@ -0,0 +1,118 @@
+#pragma once
+#include "Common.h"
+#include <Jolt/Physics/StateRecorder.h>
+#include <Jolt/Core/STLAlignedAllocator.h>
+#include "BindingUtility/NativeStreams.h"
+
+/// StateRecorder backed by a contiguous, cache line aligned byte buffer. Clear keeps the capacity so saving every frame doesn't allocate.
+/// The recorder can also read from external memory (e.g. a bytes object) without copying it.
+class StateRecorderBuffer final : public StateRecorder {
+  public:
+    using Buffer = Array<uint8, STLAlignedAllocator<uint8, JPH_CACHE_LINE_SIZE>>;
+
+    StateRecorderBuffer() = default;
+
+    explicit StateRecorderBuffer(size_t inReserve) {
+        mData.reserve(inReserve);
+    }
+
+    /// Fails the recorder while a view on the data is exported, growing the buffer would free the memory behind the view
+    virtual void WriteBytes(const void *inData, size_t inNumBytes) override {
+        if (mExports.IsExported()) {
+            mFailed = true;
+            return;
+        }
+        size_t size = mData.size();
+        if (size + inNumBytes > mData.capacity())
+            mData.reserve(max(2 * mData.capacity(), size + inNumBytes));
+        mData.resize(size + inNumBytes);
+        memcpy(mData.data() + size, inData, inNumBytes);
+    }
+
+    virtual void ReadBytes(void *outData, size_t inNumBytes) override {
+        const uint8 *data = GetReadData();
+        if (mFailed || inNumBytes > GetReadSize() - mReadPosition) {
+            mEOF = mFailed = true;
+            return;
+        }
+
+        if (IsValidating() && inNumBytes > 0 && memcmp(outData, data + mReadPosition, inNumBytes) != 0) {
+            // Mismatch between the current and the recorded state, count it and continue with the recorded state
+            ++mNumMismatches;
+            Trace("Mismatch reading %u bytes at offset %u", (uint)inNumBytes, (uint)mReadPosition);
+        }
+
+        memcpy(outData, data + mReadPosition, inNumBytes);
+        mReadPosition += inNumBytes;
+    }
+
+    virtual bool IsEOF() const override {
+        return mEOF;
+    }
+
+    virtual bool IsFailed() const override {
+        return mFailed;
+    }
+
+    /// Start reading from the beginning
+    void Rewind() {
+        mReadPosition = 0;
+        mEOF = mFailed = false;
+        mNumMismatches = 0;
+    }
+
+    /// Remove all data for reuse, keeps the capacity
+    void Clear() {
+        mData.clear();
+        mExternalData = nullptr;
+        mExternalSize = 0;
+        Rewind();
+    }
+
+    void Reserve(size_t inNumBytes) {
+        mData.reserve(inNumBytes);
+    }
+
+    /// Replace the contents with a copy of inData and rewind
+    void SetData(const void *inData, size_t inNumBytes) {
+        Clear();
+        WriteBytes(inData, inNumBytes);
+    }
+
+    /// Read from inData instead of the own buffer until the next Clear, the memory must stay valid while reading
+    void SetExternalData(const void *inData, size_t inNumBytes) {
+        Clear();
+        mExternalData = static_cast<const uint8 *>(inData);
+        mExternalSize = inNumBytes;
+    }
+
+    inline const uint8 *GetReadData() const {
+        return mExternalData != nullptr ? mExternalData : mData.data();
+    }
+
+    inline size_t GetReadSize() const {
+        return mExternalData != nullptr ? mExternalSize : mData.size();
+    }
+
+    inline const Buffer &GetData() const {
+        return mData;
+    }
+
+    inline uint GetNumMismatches() const {
+        return mNumMismatches;
+    }
+
+    inline BufferExports &GetExports() {
+        return mExports;
+    }
+
+  private:
+    Buffer mData;
+    BufferExports mExports;
+    const uint8 *mExternalData = nullptr;
+    size_t mExternalSize = 0;
+    size_t mReadPosition = 0;
+    uint mNumMismatches = 0;
+    bool mEOF = false;
+    bool mFailed = false;
+};
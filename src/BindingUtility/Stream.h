@@ -1,34 +1,93 @@
+#pragma once
 #include "Common.h"
 #include <Jolt/Core/StreamIn.h>
 #include <Jolt/Core/StreamOut.h>
 
+/// StreamOut that writes to a Python object. By default every write goes straight to the target, with a buffer size the writes are
+/// collected and flushed in large chunks, bytearrays are appended in place and buffered streams on seekable binary files are
+/// written with pwrite without the GIL. A buffered stream must be flushed before the target is used.
 class PythonStreamOut : public StreamOut {
   public:
-    PythonStreamOut(nb::object py_io_object);
+    static constexpr size_t cDefaultBufferSize = 0;
 
-    ~PythonStreamOut() override = default;
+    PythonStreamOut(nb::object py_io_object, size_t buffer_size = cDefaultBufferSize);
+
+    ~PythonStreamOut() override;
 
     void WriteBytes(const void *inData, size_t inNumBytes) override;
 
     bool IsFailed() const override;
 
+    /// Write the buffered data to the Python object, returns false if the stream failed.
+    /// When writing to the file descriptor, the position of the file object is moved to the end of the written data.
+    bool Flush();
+
   private:
+    enum class ETarget {
+        Write,
+        ByteArray,
+        FileDescriptor,
+    };
+
+    void FlushBuffer();
+
+    void WriteThrough(const void *inData, size_t inNumBytes);
+
     nb::object m_py_io;
+    ETarget m_target = ETarget::Write;
+    int m_fd = -1;
+    int64 m_fd_offset = 0;
+    Array<uint8> m_buffer;
+    size_t m_buffer_used = 0;
     bool m_failed = false;
 };
 
+/// StreamIn that reads from a Python object. Objects that expose a buffer (bytes, bytearray, memoryview, io.BytesIO) are read
+/// without copies and without the GIL, seekable files with a file descriptor are read with pread, other objects are read
+/// in large chunks through readinto (or read). Bytes that were read ahead are given back by seeking when the stream is destroyed.
 class PythonStreamIn : public StreamIn {
   public:
-    PythonStreamIn(nb::object py_io_object);
+    static constexpr size_t cDefaultBufferSize = 64 * 1024;
+
+    PythonStreamIn(nb::object py_io_object, size_t buffer_size = cDefaultBufferSize);
 
-    ~PythonStreamIn() override = default;
+    ~PythonStreamIn() override;
 
     void ReadBytes(void *outData, size_t inNumBytes) override;
     bool IsEOF() const override;
     bool IsFailed() const override;
 
   private:
+    enum class ETarget {
+        Read,
+        ReadInto,
+        Buffer,
+        FileDescriptor,
+    };
+
+    /// Read up to inMaxBytes from the source, returns 0 at the end of the stream or on failure
+    size_t ReadFromSource(void *outData, size_t inMaxBytes);
+
     nb::object m_py_io;
+    ETarget m_target = ETarget::Read;
+
+    // Buffer protocol source
+    nb::object m_view_owner;
+    Py_buffer m_view {};
+    bool m_has_view = false;
+    size_t m_view_start = 0;
+    size_t m_view_pos = 0;
+
+    // File descriptor source
+    int m_fd = -1;
+    int64 m_fd_offset = 0;
+
+    // Read ahead
+    bool m_seekable = false;
+    Array<uint8> m_buffer;
+    size_t m_buffer_pos = 0;
+    size_t m_buffer_end = 0;
+
     bool m_is_eof = false;
     bool m_is_failed = false;
-};
\ No newline at end of file
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include "Common.h"
+#include "BindingUtility/NumpyRows.h"
+
+/// Field of a structured NumPy dtype, mCount > 1 results in a sub array field
+struct RecordField {
+    const char *mName;
+    const char *mFormat;
+    int mCount;
+    size_t mOffset;
+};
+
+#ifdef JPH_DOUBLE_PRECISION
+static constexpr const char *cRealFormat = "<f8";
+#else
+static constexpr const char *cRealFormat = "<f4";
+#endif
+
+/// Create the structured NumPy dtype for a record of inItemSize bytes
+inline nb::object MakeRecordDType(const Array<RecordField> &inFields, size_t inItemSize) {
+    nb::list names, formats, offsets;
+    for (const RecordField &field : inFields) {
+        names.append(field.mName);
+        if (field.mCount == 1)
+            formats.append(field.mFormat);
+        else
+            formats.append(nb::make_tuple(field.mFormat, nb::make_tuple(field.mCount)));
+        offsets.append(field.mOffset);
+    }
+    nb::dict spec;
+    spec["names"] = names;
+    spec["formats"] = formats;
+    spec["offsets"] = offsets;
+    spec["itemsize"] = inItemSize;
+    return nb::module_::import_("numpy").attr("dtype")(spec);
+}
+
+/// Copy inCount values to a NumPy array with a structured dtype, Record must be constructible from a value
+/// and provide a static sGetFields() that describes its members
+template <class Record, class T>
+nb::object RecordsToNumpy(const T *inValues, size_t inCount) {
+    auto bytes = AllocateNumpyArray<uint8>({ inCount * sizeof(Record) });
+    memset(bytes.data(), 0, inCount * sizeof(Record));
+    for (size_t i = 0; i < inCount; ++i) {
+        Record record(inValues[i]);
+        memcpy(bytes.data() + i * sizeof(Record), &record, sizeof(Record));
+    }
+    return nb::cast(bytes).attr("view")(MakeRecordDType(Record::sGetFields(), sizeof(Record)));
+}
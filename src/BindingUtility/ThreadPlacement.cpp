@@ -0,0 +1,137 @@
+#include "Common.h"
+#include "BindingUtility/ThreadPlacement.h"
+
+#if defined(JPH_PLATFORM_LINUX)
+    #include <pthread.h>
+    #include <sched.h>
+    #include <charconv>
+    #include <fstream>
+    #include <sstream>
+#elif defined(JPH_PLATFORM_WINDOWS)
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif defined(JPH_PLATFORM_MACOS)
+    #include <pthread.h>
+#endif
+
+void ThreadPlacement::ApplyToWorker(int inThreadIndex) const {
+    if (!mCPUs.empty()) {
+        Array<int> cpu = { mCPUs[size_t(inThreadIndex) % mCPUs.size()] };
+        sSetCurrentThreadCPUs(cpu);
+    }
+
+    if (mNamePrefix.empty())
+        return;
+
+    std::string name = mNamePrefix + std::to_string(inThreadIndex);
+#if defined(JPH_PLATFORM_LINUX)
+    // Linux limits names to 15 characters
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#elif defined(JPH_PLATFORM_WINDOWS)
+    std::wstring wide_name(name.begin(), name.end());
+    SetThreadDescription(GetCurrentThread(), wide_name.c_str());
+#elif defined(JPH_PLATFORM_MACOS)
+    pthread_setname_np(name.c_str());
+#endif
+}
+
+bool ThreadPlacement::sIsAffinitySupported() {
+#if defined(JPH_PLATFORM_LINUX) || defined(JPH_PLATFORM_WINDOWS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+Array<int> ThreadPlacement::sGetCurrentThreadCPUs() {
+    Array<int> cpus;
+#if defined(JPH_PLATFORM_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &set))
+                cpus.push_back(cpu);
+#elif defined(JPH_PLATFORM_WINDOWS)
+    // There is no getter for the thread mask, set the process mask and put the old mask back to read it
+    DWORD_PTR process_mask, system_mask;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+        DWORD_PTR thread_mask = SetThreadAffinityMask(GetCurrentThread(), process_mask);
+        if (thread_mask != 0)
+            SetThreadAffinityMask(GetCurrentThread(), thread_mask);
+        else
+            thread_mask = process_mask;
+        for (int cpu = 0; cpu < int(8 * sizeof(DWORD_PTR)); ++cpu)
+            if (thread_mask & (DWORD_PTR(1) << cpu))
+                cpus.push_back(cpu);
+    }
+#endif
+    return cpus;
+}
+
+bool ThreadPlacement::sSetCurrentThreadCPUs(const Array<int> &inCPUs) {
+#if defined(JPH_PLATFORM_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : inCPUs)
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &set);
+    return CPU_COUNT(&set) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(JPH_PLATFORM_WINDOWS)
+    // Only the first processor group is supported
+    DWORD_PTR mask = 0;
+    for (int cpu : inCPUs)
+        if (cpu >= 0 && cpu < int(8 * sizeof(DWORD_PTR)))
+            mask |= DWORD_PTR(1) << cpu;
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    (void)inCPUs;
+    return false;
+#endif
+}
+
+Array<int> ThreadPlacement::sGetNumaNodeCPUs(int inNode) {
+    Array<int> cpus;
+    if (inNode < 0)
+        return cpus;
+#if defined(JPH_PLATFORM_LINUX)
+    // Ranges like "0-7,16-23"
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(inNode) + "/cpulist");
+    std::string list;
+    if (!std::getline(file, list))
+        return cpus;
+    std::stringstream ranges(list);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        if (range.empty())
+            continue;
+
+        // A malformed list is treated like a node that doesn't exist
+        const char *begin = range.data(), *end = range.data() + range.size();
+        int first = 0, last = 0;
+        std::from_chars_result result = std::from_chars(begin, end, first);
+        if (result.ec != std::errc() || first < 0)
+            return {};
+        last = first;
+        if (result.ptr != end && *result.ptr == '-')
+            result = std::from_chars(result.ptr + 1, end, last);
+        if (result.ec != std::errc() || result.ptr != end || last < first)
+            return {};
+
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+#elif defined(JPH_PLATFORM_WINDOWS)
+    ULONGLONG mask = 0;
+    if (inNode <= 0xff && GetNumaNodeProcessorMask(UCHAR(inNode), &mask))
+        for (int cpu = 0; cpu < 64; ++cpu)
+            if (mask & (ULONGLONG(1) << cpu))
+                cpus.push_back(cpu);
+#endif
+    return cpus;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "Common.h"
+#include <string>
+
+/// Placement of the worker threads of a JobSystemThreadPool, applied from the thread init function of the pool
+class ThreadPlacement {
+  public:
+    /// Pin the calling thread to mCPUs[inThreadIndex % size] and give it an OS visible name
+    void ApplyToWorker(int inThreadIndex) const;
+
+    /// Check if threads can be pinned to CPUs on this platform
+    static bool sIsAffinitySupported();
+
+    /// CPUs the calling thread is allowed to run on
+    static Array<int> sGetCurrentThreadCPUs();
+
+    /// Restrict the calling thread to inCPUs, returns false if the OS refused
+    static bool sSetCurrentThreadCPUs(const Array<int> &inCPUs);
+
+    /// CPUs that belong to NUMA node inNode, empty if the node doesn't exist
+    static Array<int> sGetNumaNodeCPUs(int inNode);
+
+    /// CPUs the workers are pinned to, one CPU per worker. Empty to leave the affinity alone.
+    Array<int> mCPUs;
+
+    /// Prefix of the thread names, the worker index is appended. Empty to keep the default name.
+    std::string mNamePrefix;
+};
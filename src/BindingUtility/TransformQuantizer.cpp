@@ -0,0 +1,116 @@
+#include "Common.h"
+#include "BindingUtility/TransformQuantizer.h"
+#include "BindingUtility/NumpyRows.h"
+#include <nanobind/ndarray.h>
+#include <nanobind/stl/optional.h>
+
+using NumpyPacked = nb::ndarray<nb::numpy, uint8, nb::shape<-1, sizeof(PackedTransform)>, nb::device::cpu, nb::c_contig>;
+using NumpyPackedIn = nb::ndarray<const uint8, nb::device::cpu, nb::c_contig>;
+
+/// View packed records in any contiguous byte buffer
+static const PackedTransform *sGetRecords(const NumpyPackedIn &inPacked, size_t &outCount) {
+    if (inPacked.nbytes() % sizeof(PackedTransform) != 0)
+        throw nb::value_error("Size of packed data must be a multiple of the record size (32 bytes)");
+    outCount = inPacked.nbytes() / sizeof(PackedTransform);
+    return reinterpret_cast<const PackedTransform *>(inPacked.data());
+}
+
+void BindTransformQuantizer(nb::module_ &m) {
+    nb::class_<TransformQuantizer> transformQuantizerCls(m, "TransformQuantizer",
+        "Packs body transforms and velocities in 32 byte records for network replication:\n"
+        "uint32 body ID, uint32 smallest three rotation (2 + 3 x 10 bits), int16[3] world cell, uint16[3] position in cell, half[3] linear and half[3] angular velocity.\n"
+        "Positions have a resolution of cell_size / 65535 and a range of +/- 32768 cells.");
+    transformQuantizerCls
+        .def(nb::init<float>(), "cell_size"_a = 64.0f,
+            "Args:\n"
+            "    cell_size (float): Size of a world cell, positions are quantized relative to the cell that contains them.")
+        .def("get_cell_size", &TransformQuantizer::GetCellSize)
+        .def("encode", [](const TransformQuantizer &self, PhysicsSystem &physics_system, const NumpyBodyIDs &body_ids, std::optional<NumpyPacked> out) {
+            size_t count = body_ids.shape(0);
+            NumpyPacked result = out ? *out : NumpyPacked(AllocateNumpyArray<uint8>({ count, sizeof(PackedTransform) }));
+            if (result.shape(0) < count)
+                throw nb::value_error("out is too small");
+
+            const uint32 *ids = body_ids.data();
+            PackedTransform *records = reinterpret_cast<PackedTransform *>(result.data());
+            {
+                nb::gil_scoped_release release;
+                const BodyLockInterfaceNoLock &lock_interface = physics_system.GetBodyLockInterfaceNoLock();
+                for (size_t i = 0; i < count; ++i)
+                    self.Encode(lock_interface.TryGetBody(BodyID(ids[i])), ids[i], records[i]);
+            }
+            return result;
+        }, "physics_system"_a, "body_ids"_a, "out"_a = nb::none(),
+            "Pack the transforms and velocities of bodies, the system must not be simulating.\n"
+            "Args:\n"
+            "    physics_system (PhysicsSystem): System that contains the bodies.\n"
+            "    body_ids (ndarray): (N,) uint32 body IDs, bodies that don't exist get an invalid ID in their record.\n"
+            "    out (ndarray, optional): (M >= N, 32) uint8 array to reuse.\n"
+            "Returns:\n"
+            "    ndarray: (N, 32) uint8 records, use tobytes() or a memoryview to send them.")
+        .def("decode", [](const TransformQuantizer &self, const NumpyPackedIn &packed) {
+            size_t count;
+            const PackedTransform *records = sGetRecords(packed, count);
+
+            auto ids = AllocateNumpyArray<uint32>({ count });
+            auto positions = AllocateNumpyArray<Real>({ count, 3 });
+            auto rotations = AllocateNumpyArray<float>({ count, 4 });
+            auto linear_velocities = AllocateNumpyArray<float>({ count, 3 });
+            auto angular_velocities = AllocateNumpyArray<float>({ count, 3 });
+            {
+                nb::gil_scoped_release release;
+                for (size_t i = 0; i < count; ++i) {
+                    const PackedTransform &record = records[i];
+                    ids.data()[i] = record.mBodyID;
+                    RVec3 position = self.DecodePosition(record);
+                    Vec4 rotation = TransformQuantizer::sDecodeRotation(record.mRotation).GetXYZW();
+                    Vec3 linear_velocity = TransformQuantizer::sDecodeHalf3(record.mLinearVelocity);
+                    Vec3 angular_velocity = TransformQuantizer::sDecodeHalf3(record.mAngularVelocity);
+                    for (int c = 0; c < 3; ++c) {
+                        positions.data()[3 * i + c] = position[c];
+                        linear_velocities.data()[3 * i + c] = linear_velocity[c];
+                        angular_velocities.data()[3 * i + c] = angular_velocity[c];
+                    }
+                    rotation.StoreFloat4(reinterpret_cast<Float4 *>(rotations.data() + 4 * i));
+                }
+            }
+
+            nb::dict result;
+            result["body_ids"] = ids;
+            result["positions"] = positions;
+            result["rotations"] = rotations;
+            result["linear_velocities"] = linear_velocities;
+            result["angular_velocities"] = angular_velocities;
+            return result;
+        }, "packed"_a,
+            "Unpack records without applying them.\n"
+            "Args:\n"
+            "    packed (bytes-like | ndarray): Records as produced by encode.\n"
+            "Returns:\n"
+            "    dict: body_ids (N,) uint32, positions (N, 3), rotations (N, 4) float32 (x, y, z, w), linear_velocities and angular_velocities (N, 3) float32.")
+        .def("apply", [](const TransformQuantizer &self, BodyInterface &body_interface, const NumpyPackedIn &packed) {
+            size_t count;
+            const PackedTransform *records = sGetRecords(packed, count);
+
+            nb::gil_scoped_release release;
+            uint num_applied = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const PackedTransform &record = records[i];
+                BodyID id(record.mBodyID);
+                if (id.IsInvalid() || !body_interface.IsAdded(id))
+                    continue;
+                body_interface.SetPositionRotationAndVelocity(id, self.DecodePosition(record), TransformQuantizer::sDecodeRotation(record.mRotation),
+                    TransformQuantizer::sDecodeHalf3(record.mLinearVelocity), TransformQuantizer::sDecodeHalf3(record.mAngularVelocity));
+                ++num_applied;
+            }
+            return num_applied;
+        }, "body_interface"_a, "packed"_a,
+            "Unpack records and set the position, rotation and velocities of the bodies.\n"
+            "Args:\n"
+            "    body_interface (BodyInterface): Interface used to update the bodies.\n"
+            "    packed (bytes-like | ndarray): Records as produced by encode.\n"
+            "Returns:\n"
+            "    int: Number of bodies that were updated, records of bodies that don't exist are skipped.");
+
+    transformQuantizerCls.attr("RECORD_SIZE") = sizeof(PackedTransform);
+}
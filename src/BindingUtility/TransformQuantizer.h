@@ -0,0 +1,120 @@
+#pragma once
+#include "Common.h"
+#include <Jolt/Math/HalfFloat.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/Body/BodyInterface.h>
+#include <Jolt/Physics/Body/BodyLockInterface.h>
+#include <cmath>
+#include <cstdint>
+
+/// Compact transform and velocity of a body for network replication
+struct PackedTransform {
+    uint32 mBodyID;
+    uint32 mRotation;               ///< Smallest three: 2 bits index of the dropped (largest) component, 3 x 10 bits for the others
+    int16 mCell[3];                 ///< World cell that contains the body
+    uint16 mPosition[3];            ///< Position inside the cell in units of cell size / 65535
+    HalfFloat mLinearVelocity[3];
+    HalfFloat mAngularVelocity[3];
+};
+
+static_assert(sizeof(PackedTransform) == 32, "PackedTransform is sent over the network, its layout must not change");
+
+/// Encodes body transforms and velocities into PackedTransform records and applies them back
+class TransformQuantizer {
+  public:
+    explicit TransformQuantizer(float inCellSize) :
+        mCellSize(inCellSize) {
+    }
+
+    /// Pack the state of a body, bodies that don't exist get an invalid ID
+    void Encode(const Body *inBody, uint32 inBodyID, PackedTransform &outRecord) const {
+        if (inBody == nullptr) {
+            memset(&outRecord, 0, sizeof(PackedTransform));
+            outRecord.mBodyID = BodyID::cInvalidBodyID;
+            return;
+        }
+
+        outRecord.mBodyID = inBodyID;
+
+        RVec3 position = inBody->GetPosition();
+        for (int i = 0; i < 3; ++i) {
+            Real scaled = position[i] / Real(mCellSize);
+            Real cell = Clamp(std::floor(scaled), Real(INT16_MIN), Real(INT16_MAX));
+            Real fraction = Clamp(scaled - cell, Real(0), Real(1));
+            outRecord.mCell[i] = int16(cell);
+            outRecord.mPosition[i] = uint16(fraction * Real(65535) + Real(0.5));
+        }
+
+        outRecord.mRotation = sEncodeRotation(inBody->GetRotation());
+
+        Vec3 linear_velocity = inBody->GetLinearVelocity();
+        Vec3 angular_velocity = inBody->GetAngularVelocity();
+        for (int i = 0; i < 3; ++i) {
+            outRecord.mLinearVelocity[i] = HalfFloatConversion::FromFloat<HalfFloatConversion::ERoundingMode::ROUND_TO_NEAREST>(linear_velocity[i]);
+            outRecord.mAngularVelocity[i] = HalfFloatConversion::FromFloat<HalfFloatConversion::ERoundingMode::ROUND_TO_NEAREST>(angular_velocity[i]);
+        }
+    }
+
+    RVec3 DecodePosition(const PackedTransform &inRecord) const {
+        RVec3 position;
+        for (int i = 0; i < 3; ++i)
+            position.SetComponent(i, (Real(inRecord.mCell[i]) + Real(inRecord.mPosition[i]) / Real(65535)) * Real(mCellSize));
+        return position;
+    }
+
+    static Vec3 sDecodeHalf3(const HalfFloat *inValues) {
+        UVec4 packed(uint32(inValues[0]) | (uint32(inValues[1]) << 16), uint32(inValues[2]), 0, 0);
+        return Vec3(HalfFloatConversion::ToFloat(packed));
+    }
+
+    /// Smallest three encoding of a unit quaternion
+    static uint32 sEncodeRotation(QuatArg inRotation) {
+        Vec4 q = inRotation.Normalized().GetXYZW();
+        Vec4 abs_q = q.Abs();
+        int largest = 0;
+        for (int i = 1; i < 4; ++i)
+            if (abs_q[i] > abs_q[largest])
+                largest = i;
+
+        // q and -q are the same rotation, make the dropped component positive so it can be reconstructed
+        if (q[largest] < 0.0f)
+            q = -q;
+
+        uint32 result = uint32(largest) << 30;
+        int shift = 20;
+        for (int i = 0; i < 4; ++i)
+            if (i != largest) {
+                float normalized = Clamp(q[i] * cInvRange * 0.5f + 0.5f, 0.0f, 1.0f);
+                result |= uint32(normalized * 1023.0f + 0.5f) << shift;
+                shift -= 10;
+            }
+        return result;
+    }
+
+    static Quat sDecodeRotation(uint32 inRotation) {
+        int largest = int(inRotation >> 30);
+        float components[4];
+        float sum_sq = 0.0f;
+        int shift = 20;
+        for (int i = 0; i < 4; ++i)
+            if (i != largest) {
+                float normalized = float((inRotation >> shift) & 1023) / 1023.0f;
+                components[i] = (normalized * 2.0f - 1.0f) * cRange;
+                sum_sq += Square(components[i]);
+                shift -= 10;
+            }
+        components[largest] = std::sqrt(max(0.0f, 1.0f - sum_sq));
+        return Quat(components[0], components[1], components[2], components[3]).Normalized();
+    }
+
+    inline float GetCellSize() const {
+        return mCellSize;
+    }
+
+  private:
+    /// The components that are not the largest are in [-1/sqrt(2), 1/sqrt(2)]
+    static constexpr float cRange = 0.70710678f;
+    static constexpr float cInvRange = 1.41421356f;
+
+    float mCellSize;
+};
@@ -21,6 +21,8 @@
 #include <Jolt/Physics/Vehicle/Wheel.h>
 #include <Jolt/Physics/Collision/CastResult.h>
 #include <Jolt/Physics/Collision/ShapeCast.h>
+#include <Jolt/Physics/Collision/CollidePointResult.h>
+#include <Jolt/Physics/Collision/TransformedShape.h>
 #include <Jolt/Physics/Collision/BroadPhase/QuadTree.h>
 #include <Jolt/Geometry/AABox.h>
 #include <Jolt/Geometry/Plane.h>
@@ -33,9 +35,12 @@
 #include <Jolt/TriangleGrouper/TriangleGrouper.h>
 #include <Jolt/TriangleSplitter/TriangleSplitter.h>
 #include <Jolt/ObjectStream/TypeDeclarations.h>
+#include <Jolt/Core/UnorderedMap.h>
 
 #include <nanobind/operators.h>
 #include <nanobind/make_iterator.h>
+#include <nanobind/ndarray.h>
+#include <array>
 
 // Helper for SFINAE to detect operator== for an element type U
 template <typename U, typename = std::void_t<>>
@@ -57,6 +62,88 @@ struct has_element_operator_not_equals<U, std::void_t<decltype(std::declval<cons
 template <typename U>
 inline constexpr bool has_element_operator_not_equals_v = has_element_operator_not_equals<U>::value;
 
+// Describes how an element type is laid out in memory so Array<T> can be viewed as a NumPy array without copying.
+// Every element is a contiguous block of Scalar with shape Dims (no Dims means a single scalar).
+template <typename T>
+struct NumpyElementLayout {
+    static constexpr bool cSupported = false;
+};
+
+template <typename S, size_t... Dims>
+struct NumpyLayout {
+    static constexpr bool cSupported = true;
+    static constexpr bool cPaddedVec3 = false;
+    static constexpr size_t cNumDims = 1 + sizeof...(Dims);
+    static constexpr size_t cNumScalars = (size_t(1) * ... * Dims);
+    static constexpr std::array<size_t, sizeof...(Dims)> cElementShape = { Dims... };
+    using Scalar = S;
+};
+
+// Vec3 / DVec3 are stored as 4 components where the 4th is a copy of the 3rd
+template <typename S>
+struct NumpyPaddedVec3Layout : NumpyLayout<S, 4> {
+    static constexpr bool cPaddedVec3 = true;
+};
+
+template <> struct NumpyElementLayout<uint8> : NumpyLayout<uint8> {};
+template <> struct NumpyElementLayout<uint16> : NumpyLayout<uint16> {};
+template <> struct NumpyElementLayout<uint32> : NumpyLayout<uint32> {};
+template <> struct NumpyElementLayout<int32_t> : NumpyLayout<int32_t> {};
+template <> struct NumpyElementLayout<float> : NumpyLayout<float> {};
+template <> struct NumpyElementLayout<double> : NumpyLayout<double> {};
+template <> struct NumpyElementLayout<Float2> : NumpyLayout<float, 2> {};
+template <> struct NumpyElementLayout<Float3> : NumpyLayout<float, 3> {};
+template <> struct NumpyElementLayout<Float4> : NumpyLayout<float, 4> {};
+template <> struct NumpyElementLayout<Vec3> : NumpyPaddedVec3Layout<float> {};
+template <> struct NumpyElementLayout<Vec4> : NumpyLayout<float, 4> {};
+template <> struct NumpyElementLayout<DVec3> : NumpyPaddedVec3Layout<double> {};
+template <> struct NumpyElementLayout<Mat44> : NumpyLayout<float, 4, 4> {};        // Column major: [index, column, row]
+template <> struct NumpyElementLayout<Plane> : NumpyLayout<float, 4> {};           // Normal xyz, constant
+template <> struct NumpyElementLayout<BodyID> : NumpyLayout<uint32> {};
+template <> struct NumpyElementLayout<IndexedTriangleNoMaterial> : NumpyLayout<uint32, 3> {};
+template <> struct NumpyElementLayout<IndexedTriangle> : NumpyLayout<uint32, sizeof(IndexedTriangle) / sizeof(uint32)> {};   // Indices, material index, user data
+template <> struct NumpyElementLayout<SoftBodySharedSettings::Face> : NumpyLayout<uint32, 4> {};                             // Indices, material index
+template <> struct NumpyElementLayout<SoftBodySharedSettings::Vertex> : NumpyLayout<float, 7> {};                            // Position, velocity, inverse mass
+
+// Arrays with NumPy / DLPack views on their memory and the number of views. Array<T> has no room for a counter so exports are
+// counted by address, the GIL protects the table. Like bytearray, an exported array refuses every operation that can move or resize its memory.
+static UnorderedMap<const void *, uint32> sArrayExports;
+
+static void ThrowIfExported(const void *inArray) {
+    if (!sArrayExports.empty() && sArrayExports.find(inArray) != sArrayExports.end())
+        throw nb::buffer_error("Existing exports of data: object cannot be re-sized");
+}
+
+// Owner of a view on inArray, keeps the Python object of the array alive and counts as an export until the view is released
+static nb::capsule MakeArrayExport(nb::handle inArrayObject, const void *inArray) {
+    struct Export {
+        const void *mArray;
+        PyObject *mArrayObject;
+    };
+    ++sArrayExports[inArray];
+    return nb::capsule(new Export { inArray, inArrayObject.inc_ref().ptr() }, [](void *inExport) noexcept {
+        Export *e = static_cast<Export *>(inExport);
+        UnorderedMap<const void *, uint32>::iterator it = sArrayExports.find(e->mArray);
+        if (--it->second == 0)
+            sArrayExports.erase(it);
+        Py_DECREF(e->mArrayObject);
+        delete e;
+    });
+}
+
+// Zero copy view on the memory of an Array<T>, the array can't be resized while the view is alive
+template <typename NDArray, typename T>
+NDArray MakeArrayView(nb::pointer_and_handle<Array<T>> inArray) {
+    using Layout = NumpyElementLayout<T>;
+    static_assert(sizeof(T) == Layout::cNumScalars * sizeof(typename Layout::Scalar), "Element layout doesn't match element size");
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    size_t shape[Layout::cNumDims] = { inArray.p->size() };
+    for (size_t i = 1; i < Layout::cNumDims; ++i)
+        shape[i] = Layout::cElementShape[i - 1];
+    return NDArray(inArray.p->data(), Layout::cNumDims, shape, MakeArrayExport(inArray.h, inArray.p));
+}
+
 template <typename T, bool BindComparisonOp = true, bool BindConstructor = true, bool BindSetter = true>
 nb::class_<Array<T>> BindInst(nb::module_ &m, std::string name) {
     using ArrayT = Array<T>;
@@ -86,30 +173,59 @@ nb::class_<Array<T>> BindInst(nb::module_ &m, std::string name) {
      cls.def(nb::init<const Array<T, Allocator> &>(), "rhs"_a, "Copy constructor")
         .def(nb::init<const Array<T, Allocator> &&>(), "rhs"_a, "Move constructor")
 
-        .def("reserve", &ArrayT::reserve, "new_size"_a, "Reserve array space")
-        .def("resize", nb::overload_cast<size_t>(&ArrayT::resize), "new_size"_a, "Destruct all elements and set length to zero")
-        .def("clear", &ArrayT::clear, "Destruct all elements and set length to zero")
+        // Operations that change the size or move the memory raise BufferError while a NumPy / DLPack view is alive
+        .def("reserve", [](ArrayT &self, size_t new_size) {
+            ThrowIfExported(&self);
+            self.reserve(new_size);
+        }, "new_size"_a, "Reserve array space")
+        .def("resize", [](ArrayT &self, size_t new_size) {
+            ThrowIfExported(&self);
+            self.resize(new_size);
+        }, "new_size"_a, "Destruct all elements and set length to zero")
+        .def("clear", [](ArrayT &self) {
+            ThrowIfExported(&self);
+            self.clear();
+        }, "Destruct all elements and set length to zero")
 
         .def("assign", [](ArrayT &self, ArrayT &other, uint begin_idx, uint end_idx) {
+            ThrowIfExported(&self);
             self.assign(other.begin() + begin_idx, other.begin() + end_idx);
         }, "other"_a, "begin_index"_a, "end_index"_a, "Replace the contents of this array with inList")
         .def("get_allocator", nb::overload_cast<>(&ArrayT::get_allocator), "Get the allocator")
-        .def("push_back", nb::overload_cast<const T &>(&ArrayT::push_back), "value"_a, "Add element to the back of the array")
-        .def("emplace_back", &ArrayT::template emplace_back<T>, "value"_a, "Construct element at the back of the array")
-        .def("pop_back", &ArrayT::pop_back, "Remove element from the back of the array")
+        .def("push_back", [](ArrayT &self, const T &value) {
+            ThrowIfExported(&self);
+            self.push_back(value);
+        }, "value"_a, "Add element to the back of the array")
+        .def("emplace_back", [](ArrayT &self, const T &value) -> T & {
+            ThrowIfExported(&self);
+            return self.emplace_back(value);
+        }, "value"_a, "Construct element at the back of the array")
+        .def("pop_back", [](ArrayT &self) {
+            ThrowIfExported(&self);
+            self.pop_back();
+        }, "Remove element from the back of the array")
         .def("empty", &ArrayT::empty, "Returns true if there are no elements in the array")
         .def("size", &ArrayT::size, "Returns amount of elements in the array")
         .def("capacity", &ArrayT::capacity, "Returns maximum amount of elements the array can hold")
-        .def("shrink_to_fit", &ArrayT::shrink_to_fit, "Reduce the capacity of the array to match its size")
-        .def("swap", &ArrayT::swap, "rhs"_a, "Swap the contents of two arrays")
+        .def("shrink_to_fit", [](ArrayT &self) {
+            ThrowIfExported(&self);
+            self.shrink_to_fit();
+        }, "Reduce the capacity of the array to match its size")
+        .def("swap", [](ArrayT &self, ArrayT &rhs) {
+            ThrowIfExported(&self);
+            ThrowIfExported(&rhs);
+            self.swap(rhs);
+        }, "rhs"_a, "Swap the contents of two arrays")
         .def("insert", [](ArrayT &arr, size_t index, const T &value) {
             if (index > arr.size())
                 throw nb::index_error("Index out of range");
+            ThrowIfExported(&arr);
             arr.insert(arr.begin() + index, value);
         }, "index"_a, "value"_a)
         .def("erase", [](ArrayT &arr, size_t index) {
             if (index >= arr.size())
                 throw nb::index_error("Index out of range");
+            ThrowIfExported(&arr);
             arr.erase(arr.begin() + index);
         }, "index"_a, "Remove one element from the array")
 
@@ -153,6 +269,7 @@ nb::class_<Array<T>> BindInst(nb::module_ &m, std::string name) {
         .def("erase_range", [](ArrayT &arr, size_t begin, size_t end) {
             if (begin > arr.size() || end > arr.size() || begin > end)
                 throw nb::index_error("Invalid range");
+            ThrowIfExported(&arr);
             arr.erase(arr.begin() + begin, arr.begin() + end);
         }, "begin"_a, "end"_a)
         .def("to_list", [](const ArrayT &a) {
@@ -176,6 +293,78 @@ nb::class_<Array<T>> BindInst(nb::module_ &m, std::string name) {
             return str;
         });
 
+    if constexpr (NumpyElementLayout<T>::cSupported) {
+        using Layout = NumpyElementLayout<T>;
+        using Scalar = typename Layout::Scalar;
+        // Writing a padded Vec3 through a view could break W == Z, so those views are read-only
+        using ViewScalar = std::conditional_t<Layout::cPaddedVec3, const Scalar, Scalar>;
+        using NumpyView = nb::ndarray<nb::numpy, ViewScalar>;
+        using NumpyInput = nb::ndarray<nb::numpy, const Scalar, nb::device::cpu, nb::c_contig>;
+
+        cls
+            .def("to_numpy", [](nb::pointer_and_handle<ArrayT> self) {
+                return MakeArrayView<NumpyView>(self);
+            },
+                "Zero copy NumPy view on the array data. While the view is alive the array can't be resized (BufferError), like a bytearray.\n"
+                "Views of Vec3 / DVec3 arrays are read-only because the 4th component must stay equal to the 3rd.")
+            .def("__array__", [](nb::pointer_and_handle<ArrayT> self, nb::handle dtype, nb::handle copy) {
+                nb::object result = nb::cast(MakeArrayView<NumpyView>(self));
+                bool force_copy = !copy.is_none() && nb::cast<bool>(copy);
+                bool allow_copy = copy.is_none() || force_copy;
+                if (!dtype.is_none()) {
+                    nb::object target = nb::module_::import_("numpy").attr("dtype")(dtype);
+                    if (!target.equal(result.attr("dtype"))) {
+                        if (!allow_copy)
+                            throw nb::value_error("Unable to avoid copy while creating an array as requested, the dtype differs from the array data");
+                        return result.attr("astype")(target);
+                    }
+                }
+                if (force_copy)
+                    result = result.attr("copy")();
+                return result;
+            }, "dtype"_a.none() = nb::none(), "copy"_a.none() = nb::none(),
+                "NumPy array protocol, numpy.asarray returns a zero copy view (see to_numpy)")
+            .def("__dlpack__", [](nb::pointer_and_handle<ArrayT> self, nb::kwargs kwargs) {
+                nb::object view = nb::cast(MakeArrayView<nb::ndarray<ViewScalar>>(self));
+                return view.attr("__dlpack__")(**kwargs);
+            }, "DLPack protocol, exports the array data without copying (see to_numpy)")
+            .def("__dlpack_device__", [](const ArrayT &) {
+                return nb::make_tuple((int)nb::device::cpu::value, 0);
+            })
+            .def_static("from_numpy", [](const NumpyInput &inData) {
+                // Vec3 / DVec3 accept 3 or 4 components, the 4th is recomputed from the 3rd to keep the padding invariant
+                bool shape_ok = inData.ndim() == Layout::cNumDims;
+                for (size_t i = 1; shape_ok && i < Layout::cNumDims; ++i)
+                    shape_ok = inData.shape(i) == Layout::cElementShape[i - 1] || (Layout::cPaddedVec3 && inData.shape(i) == 3);
+                if (!shape_ok) {
+                    std::string expected = "(N";
+                    for (size_t dim : Layout::cElementShape)
+                        expected += ", " + std::to_string(dim);
+                    expected += Layout::cPaddedVec3 ? ") or (N, 3)" : ")";
+                    throw nb::value_error(("Expected an array of shape " + expected + ", got ndim " + std::to_string(inData.ndim())).c_str());
+                }
+
+                size_t count = inData.shape(0);
+                const Scalar *data = inData.data();
+
+                ArrayT result;
+                if constexpr (Layout::cPaddedVec3) {
+                    size_t stride = inData.shape(1);
+                    result.reserve(count);
+                    for (size_t i = 0; i < count; ++i, data += stride)
+                        result.push_back(T(data[0], data[1], data[2]));
+                    return result;
+                }
+
+                result.resize(count);
+                if (count > 0)
+                    memcpy(result.data(), data, count * sizeof(T));
+                return result;
+            }, "array"_a,
+                "Create an array from a NumPy array with a single memcpy, the shape must match to_numpy.\n"
+                "Vec3 / DVec3 accept (N, 3) or (N, 4), the 4th component is ignored and set to the 3rd like in to_numpy.");
+    }
+
     return cls;
 }
 
@@ -288,6 +477,11 @@ void BindArray(nb::module_ &m) {
     BindInst<QuadTree::Tracking, true, true, false>(m, "QuadTreeTracking");
 
     BindInst<ShapeCastResult, false, false>(m, "ShapeCastResult");
+    BindInst<RayCastResult, false, false>(m, "RayCastResult");
+    BindInst<BroadPhaseCastResult, false, false>(m, "BroadPhaseCastResult");
+    BindInst<CollideShapeResult, false, false>(m, "CollideShapeResult");
+    BindInst<CollidePointResult, false, false>(m, "CollidePointResult");
+    BindInst<TransformedShape, false, false>(m, "TransformedShape");
 
     // TODO:
             BindInst<Body *, false, false>(m, "ConvexHullBuilderFaceP");
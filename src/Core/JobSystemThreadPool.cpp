@@ -1,6 +1,41 @@
 #include "Common.h"
 #include <Jolt/Core/JobSystem.h>
 #include <Jolt/Core/JobSystemThreadPool.h>
+#include "BindingUtility/ParallelFor.h"
+#include "BindingUtility/ParallelKernels.h"
+#include "BindingUtility/ThreadPlacement.h"
+#include <nanobind/stl/optional.h>
+#include <nanobind/stl/string.h>
+#include <nanobind/stl/vector.h>
+#include <algorithm>
+
+/// Stops the worker threads without holding the GIL, a thread exit function that takes the GIL would otherwise deadlock the join.
+/// Adds no members so it is constructed in the storage of the bound JobSystemThreadPool, the virtual destructor dispatches here.
+class PyJobSystemThreadPool final : public JobSystemThreadPool {
+  public:
+    using JobSystemThreadPool::JobSystemThreadPool;
+
+    virtual ~PyJobSystemThreadPool() override {
+        if (PyGILState_Check()) {
+            nb::gil_scoped_release release;
+            SetNumThreads(0);
+        } else
+            SetNumThreads(0);
+    }
+};
+static_assert(sizeof(PyJobSystemThreadPool) == sizeof(JobSystemThreadPool));
+
+/// Wrap a Python callable as thread init / exit function, an exception is reported as unraisable instead of terminating the worker
+static std::function<void(int)> sWrapThreadFunction(nb::callable inFunction, const char *inName) {
+    return [inFunction, inName](int inThreadIndex) {
+        nb::gil_scoped_acquire gil;
+        try {
+            inFunction(inThreadIndex);
+        } catch (nb::python_error &e) {
+            e.discard_as_unraisable(inName);
+        }
+    };
+}
 
 void BindJobSystemThreadPool(nb::module_ &m) {
     nb::class_<JobSystemThreadPool, JobSystemWithBarrier>(m, "JobSystemThreadPool",
@@ -8,25 +43,139 @@ void BindJobSystemThreadPool(nb::module_ &m) {
         "Note that this is considered an example implementation. It is expected that when you integrate\n"
         "the physics engine into your own project that you'll provide your own implementation of the\n"
         "JobSystem built on top of whatever job system your project uses.")
-        .def(nb::init<uint, uint, int>(), "max_jobs"_a, "max_barriers"_a, "num_threads"_a)
-        .def(nb::init<>())
+        .def("__init__", [](JobSystemThreadPool *self, uint max_jobs, uint max_barriers, int num_threads) {
+            new (self) PyJobSystemThreadPool(max_jobs, max_barriers, num_threads);
+        }, "max_jobs"_a, "max_barriers"_a, "num_threads"_a, nb::call_guard<nb::gil_scoped_release>())
+        .def("__init__", [](JobSystemThreadPool *self) {
+            new (self) PyJobSystemThreadPool();
+        })
+
+        .def("init", [](JobSystemThreadPool &self, uint max_jobs, uint max_barriers, int num_threads, std::optional<std::vector<int>> cpus,
+                        std::optional<int> numa_node, int reserved_cores, std::optional<std::string> thread_name) {
+            if (!cpus && !numa_node && reserved_cores == 0 && !thread_name) {
+                self.Init(max_jobs, max_barriers, num_threads);
+                return;
+            }
+
+            ThreadPlacement placement;
+            if (thread_name)
+                placement.mNamePrefix = *thread_name;
+
+            Array<int> node_cpus;
+            if (cpus || numa_node || reserved_cores != 0) {
+                if (!ThreadPlacement::sIsAffinitySupported())
+                    throw nb::value_error("cpus, numa_node and reserved_cores are not supported on this platform");
+                if (reserved_cores < 0)
+                    throw nb::value_error("reserved_cores must not be negative");
+
+                if (numa_node) {
+                    node_cpus = ThreadPlacement::sGetNumaNodeCPUs(*numa_node);
+                    if (node_cpus.empty())
+                        throw nb::value_error("numa_node does not exist");
+                }
+
+                Array<int> available;
+                if (cpus)
+                    available.assign(cpus->begin(), cpus->end());
+                else if (numa_node)
+                    available = node_cpus;
+                else
+                    available = ThreadPlacement::sGetCurrentThreadCPUs();
+                if (cpus && numa_node)
+                    available.erase(std::remove_if(available.begin(), available.end(), [&node_cpus](int inCPU) {
+                        return std::find(node_cpus.begin(), node_cpus.end(), inCPU) == node_cpus.end();
+                    }), available.end());
+
+                // The first CPUs are left to the main thread
+                if (size_t(reserved_cores) >= available.size())
+                    throw nb::value_error("No CPUs left for the worker threads");
+                placement.mCPUs.assign(available.begin() + reserved_cores, available.end());
 
-        .def("init", &JobSystemThreadPool::Init, "max_jobs"_a, "max_barriers"_a, "num_threads"_a = -1,
+                if (num_threads < 0)
+                    num_threads = int(placement.mCPUs.size());
+            }
+
+            self.SetThreadInitFunction([placement](int inThreadIndex) {
+                placement.ApplyToWorker(inThreadIndex);
+            });
+
+            if (node_cpus.empty()) {
+                self.Init(max_jobs, max_barriers, num_threads);
+                return;
+            }
+
+            // Pages are placed on the node of the thread that first touches them, so allocate the job and barrier storage from the node.
+            // The job free list allocates its pages on first use, create max_jobs jobs while pinned so all of them are touched here.
+            // The free jobs are not queued because they wait on a dependency and are destructed when their handles are released.
+            Array<int> calling_thread_cpus = ThreadPlacement::sGetCurrentThreadCPUs();
+            ThreadPlacement::sSetCurrentThreadCPUs(node_cpus);
+            self.Init(max_jobs, max_barriers, num_threads);
+            {
+                Array<JobHandle> jobs;
+                jobs.reserve(max_jobs);
+                for (uint i = 0; i < max_jobs; ++i)
+                    jobs.push_back(self.CreateJob("PlaceJobStorage", Color::sBlack, []() { }, 1));
+            }
+            ThreadPlacement::sSetCurrentThreadCPUs(calling_thread_cpus);
+        }, "max_jobs"_a, "max_barriers"_a, "num_threads"_a = -1, nb::kw_only(), "cpus"_a = nb::none(), "numa_node"_a = nb::none(),
+            "reserved_cores"_a = 0, "thread_name"_a = nb::none(),
             "Initialize the thread pool.\n"
             "Args:\n"
             "    max_jobs (int): Max number of jobs that can be allocated at any time\n"
             "    max_barriers (int): Max number of barriers that can be allocated at any time\n"
-            "    num_threads (int): Number of threads to start (the number of concurrent jobs is 1 more because the main thread will also run jobs while waiting for a barrier to complete). Use -1 to auto detect the amount of CPU's.")
+            "    num_threads (int): Number of threads to start (the number of concurrent jobs is 1 more because the main thread will also run jobs while waiting for a barrier to complete). Use -1 to auto detect the amount of CPU's, or one thread per CPU when the workers are pinned.\n"
+            "    cpus (list[int], optional): CPUs to pin the workers to, one CPU per worker. Defaults to the CPUs the calling thread may run on when numa_node or reserved_cores is used.\n"
+            "    numa_node (int, optional): Only use the CPUs of this NUMA node and allocate the job and barrier storage on it (Linux and Windows). The job queue is part of the thread pool object and stays where it was allocated.\n"
+            "    reserved_cores (int): Number of CPUs at the start of the CPU list that are left to the main thread, pin the Python thread to them with os.sched_setaffinity.\n"
+            "    thread_name (str, optional): Prefix of the OS visible worker thread names, the worker index is appended.\n"
+            "The options install a native thread init function, replacing one set with set_thread_init_function.")
         .def("get_max_concurrency", &JobSystemThreadPool::GetMaxConcurrency)
-        .def("set_num_threads", &JobSystemThreadPool::SetNumThreads, "num_threads"_a, "Change the max concurrency after initialization")
-        .def("set_thread_init_function", [](JobSystemThreadPool &self, nb::callable &func) {
-            self.SetThreadInitFunction([&func](int threadIndex) {
-                func(threadIndex);
-            });
-        }, "function"_a)
-        .def("SetThreadExitFunction", [](JobSystemThreadPool &self, nb::callable &func) {
-            self.SetThreadExitFunction([&func](int threadIndex) {
-                func(threadIndex);
+        .def("set_num_threads", &JobSystemThreadPool::SetNumThreads, "num_threads"_a, nb::call_guard<nb::gil_scoped_release>(),
+            "Change the max concurrency after initialization")
+        .def("parallel_for", [](JobSystemThreadPool &self, nb::handle kernel, std::optional<size_t> count, uintptr_t user_data, size_t batch_size) {
+            if (batch_size == 0)
+                throw nb::value_error("batch_size must be larger than 0");
+
+            if (nb::isinstance<ParallelKernel>(kernel)) {
+                const ParallelKernel *native_kernel = nb::cast<const ParallelKernel *>(kernel);
+                size_t num_elements = count.value_or(native_kernel->GetCount());
+                if (num_elements > native_kernel->GetCount())
+                    throw nb::value_error("count is larger than the number of elements of the kernel");
+
+                nb::gil_scoped_release release;
+                ParallelFor(&self, num_elements, batch_size, [native_kernel](size_t inBegin, size_t inEnd) {
+                    native_kernel->Run(inBegin, inEnd);
+                });
+                return;
+            }
+
+            // A C function void (*)(uint64 begin, uint64 end, void *user_data) from a capsule or an address (e.g. ctypes.cast(f, ctypes.c_void_p).value)
+            using KernelFunction = void (*)(uint64, uint64, void *);
+            KernelFunction function = nb::isinstance<nb::capsule>(kernel) ? reinterpret_cast<KernelFunction>(nb::borrow<nb::capsule>(kernel).data()) : reinterpret_cast<KernelFunction>(nb::cast<uintptr_t>(kernel));
+            if (function == nullptr)
+                throw nb::value_error("kernel is a null function pointer");
+            if (!count)
+                throw nb::value_error("count is required when kernel is a function pointer");
+
+            nb::gil_scoped_release release;
+            ParallelFor(&self, *count, batch_size, [function, user_data](size_t inBegin, size_t inEnd) {
+                function(inBegin, inEnd, reinterpret_cast<void *>(user_data));
             });
-        }, "function"_a);
+        }, "kernel"_a, "count"_a = nb::none(), "user_data"_a = 0, "batch_size"_a = 4096,
+            "Run a kernel over [0, count) split in batches on the worker threads of this pool, the calling thread helps and the GIL is released.\n"
+            "Args:\n"
+            "    kernel (ParallelKernel | capsule | int): Native kernel (e.g. TransformPointsKernel), or a C function void (*)(uint64_t begin, uint64_t end, void *user_data)\n"
+            "        passed as capsule or as address. The function is called concurrently from multiple threads and must not call into Python.\n"
+            "    count (int): Number of elements, defaults to all elements of a native kernel. Required for function pointers.\n"
+            "    user_data (int): Address passed to the function pointer.\n"
+            "    batch_size (int): Number of elements per batch.")
+        .def("set_thread_init_function", [](JobSystemThreadPool &self, nb::callable func) {
+            self.SetThreadInitFunction(sWrapThreadFunction(func, "JobSystemThreadPool thread init function"));
+        }, "function"_a, "Set a function to be called on each worker thread when it starts, must be called before init. Exceptions are reported through sys.unraisablehook.")
+        .def("set_thread_exit_function", [](JobSystemThreadPool &self, nb::callable func) {
+            self.SetThreadExitFunction(sWrapThreadFunction(func, "JobSystemThreadPool thread exit function"));
+        }, "function"_a, "Set a function to be called on each worker thread when it exits, must be called before init. Exceptions are reported through sys.unraisablehook.")
+        .def("SetThreadExitFunction", [](JobSystemThreadPool &self, nb::callable func) {
+            self.SetThreadExitFunction(sWrapThreadFunction(func, "JobSystemThreadPool thread exit function"));
+        }, "function"_a, "Deprecated, use set_thread_exit_function");
 }
@@ -2,9 +2,91 @@
 #include <Jolt/Core/StreamIn.h>
 #include <BindingUtility/Stream.h>
 
-PythonStreamIn::PythonStreamIn(nb::object py_io_object) : m_py_io(py_io_object) {
-    if (!nb::hasattr(m_py_io, "read")) {
-        throw nb::type_error("Object provided to StreamIn must have a 'read' method that returns bytes.");
+#ifndef JPH_PLATFORM_WINDOWS
+    #include <unistd.h>
+    #include <errno.h>
+#endif
+
+PythonStreamIn::PythonStreamIn(nb::object py_io_object, size_t buffer_size) : m_py_io(py_io_object) {
+
+    // Objects that expose their memory are read in place, the buffer export keeps e.g. a bytearray from being resized
+    nb::object buffer_source;
+    if (PyObject_CheckBuffer(m_py_io.ptr()))
+        buffer_source = m_py_io;
+    else if (nb::isinstance(m_py_io, nb::module_::import_("io").attr("BytesIO"))) {
+        buffer_source = m_py_io.attr("getbuffer")();
+        m_view_start = nb::cast<size_t>(m_py_io.attr("tell")());
+    }
+    if (buffer_source.is_valid()) {
+        if (PyObject_GetBuffer(buffer_source.ptr(), &m_view, PyBUF_C_CONTIGUOUS) == 0) {
+            m_view_owner = buffer_source;
+            m_has_view = true;
+            m_view_pos = m_view_start;
+            m_target = ETarget::Buffer;
+            return;
+        }
+        PyErr_Clear();
+        m_view_start = 0;
+    }
+
+#ifndef JPH_PLATFORM_WINDOWS
+    if (nb::hasattr(m_py_io, "fileno")) {
+        // Read from the file descriptor at the position of the file object, pread leaves the state of the file object alone
+        try {
+            int fd = nb::cast<int>(m_py_io.attr("fileno")());
+            int64 offset = nb::cast<int64>(m_py_io.attr("tell")());
+            if (lseek(fd, 0, SEEK_CUR) != -1) {
+                m_fd = fd;
+                m_fd_offset = offset;
+                m_target = ETarget::FileDescriptor;
+                m_seekable = true;
+            }
+        } catch (const nb::python_error &) {
+        } catch (const nb::cast_error &) {
+        }
+    }
+#endif
+
+    if (m_target != ETarget::FileDescriptor) {
+        if (nb::hasattr(m_py_io, "readinto"))
+            m_target = ETarget::ReadInto;
+        else if (!nb::hasattr(m_py_io, "read"))
+            throw nb::type_error("Object provided to StreamIn must have a 'read' method that returns bytes.");
+
+        // Reading ahead is only possible when the bytes that were not used can be given back
+        try {
+            m_seekable = nb::hasattr(m_py_io, "seekable") && nb::cast<bool>(m_py_io.attr("seekable")());
+        } catch (const nb::python_error &) {
+        }
+    }
+
+    if (m_seekable)
+        m_buffer.resize(buffer_size);
+}
+
+PythonStreamIn::~PythonStreamIn() {
+    nb::gil_scoped_acquire gil;
+
+    if (m_has_view) {
+        // io.BytesIO is read through a view from getbuffer, move its position past the bytes that were read
+        bool is_bytes_io = !m_view_owner.is(m_py_io);
+        PyBuffer_Release(&m_view);
+        m_view_owner.reset();
+        if (is_bytes_io && m_view_pos != m_view_start) {
+            try {
+                m_py_io.attr("seek")(m_view_pos);
+            } catch (const nb::python_error &) {
+            }
+        }
+        return;
+    }
+
+    try {
+        if (m_target == ETarget::FileDescriptor)
+            m_py_io.attr("seek")(m_fd_offset - int64(m_buffer_end - m_buffer_pos));
+        else if (m_buffer_end > m_buffer_pos)
+            m_py_io.attr("seek")(-int64(m_buffer_end - m_buffer_pos), 1);
+    } catch (const nb::python_error &) {
     }
 }
 
@@ -13,18 +95,81 @@ void PythonStreamIn::ReadBytes(void *outData, size_t inNumBytes) {
     if (m_is_failed)
         return;
 
-    try {
-        nb::bytes read_data = nb::cast<nb::bytes>(m_py_io.attr("read")(inNumBytes));
+    if (m_target == ETarget::Buffer) {
+        if (m_view_pos + inNumBytes > size_t(m_view.len)) {
+            m_is_eof = true;
+            m_is_failed = true;
+            return;
+        }
+        memcpy(outData, static_cast<const uint8 *>(m_view.buf) + m_view_pos, inNumBytes);
+        m_view_pos += inNumBytes;
+        return;
+    }
 
-        if (read_data.size() < inNumBytes) {
+    uint8 *out = static_cast<uint8 *>(outData);
+    while (inNumBytes > 0) {
+        size_t available = m_buffer_end - m_buffer_pos;
+        if (available > 0) {
+            size_t num_bytes = min(available, inNumBytes);
+            memcpy(out, m_buffer.data() + m_buffer_pos, num_bytes);
+            m_buffer_pos += num_bytes;
+            out += num_bytes;
+            inNumBytes -= num_bytes;
+            continue;
+        }
+
+        // Large reads (and all reads from streams that can't seek back) go straight to the output
+        bool direct = inNumBytes >= m_buffer.size();
+        size_t num_read = direct ? ReadFromSource(out, inNumBytes) : ReadFromSource(m_buffer.data(), m_buffer.size());
+        if (num_read == 0) {
             m_is_eof = true;
             m_is_failed = true;
             return;
         }
+        if (direct) {
+            out += num_read;
+            inNumBytes -= num_read;
+        } else {
+            m_buffer_pos = 0;
+            m_buffer_end = num_read;
+        }
+    }
+}
+
+size_t PythonStreamIn::ReadFromSource(void *outData, size_t inMaxBytes) {
+#ifndef JPH_PLATFORM_WINDOWS
+    if (m_target == ETarget::FileDescriptor) {
+        for (;;) {
+            ssize_t num_read = pread(m_fd, outData, inMaxBytes, m_fd_offset);
+            if (num_read < 0 && errno == EINTR)
+                continue;
+            if (num_read <= 0)
+                return 0;
+            m_fd_offset += num_read;
+            return size_t(num_read);
+        }
+    }
+#endif
 
-        memcpy(outData, read_data.c_str(), inNumBytes);
+    // The stream can be used by code that released the GIL
+    nb::gil_scoped_acquire gil;
+    try {
+        if (m_target == ETarget::ReadInto) {
+            nb::object view = nb::steal(PyMemoryView_FromMemory(static_cast<char *>(outData), Py_ssize_t(inMaxBytes), PyBUF_WRITE));
+            if (!view.is_valid())
+                throw nb::python_error();
+            nb::object result = m_py_io.attr("readinto")(view);
+            return result.is_none() ? 0 : min(nb::cast<size_t>(result), inMaxBytes);
+        }
+
+        nb::bytes read_data = nb::cast<nb::bytes>(m_py_io.attr("read")(inMaxBytes));
+        size_t num_read = min(read_data.size(), inMaxBytes);
+        memcpy(outData, read_data.c_str(), num_read);
+        return num_read;
     } catch (const nb::python_error &e) {
-        m_is_failed = true;
+        return 0;
+    } catch (const nb::cast_error &e) {
+        return 0;
     }
 }
 
@@ -38,4 +183,15 @@ bool PythonStreamIn::IsFailed() const {
 
 void BindStreamIn(nb::module_ &m) {
     nb::class_<StreamIn, NonCopyable>(m, "StreamIn", "Simple binary input stream");
-}
\ No newline at end of file
+
+    nb::class_<PythonStreamIn, StreamIn>(m, "PythonStreamIn",
+        "StreamIn that reads from bytes-like objects, io.BytesIO, files or objects with a readinto or read method.\n"
+        "Bytes-like objects and io.BytesIO are read in place and can't be resized while the stream exists.\n"
+        "Seekable sources are read ahead, the position of the source is corrected when the stream is destroyed.")
+        .def(nb::init<nb::object, size_t>(), "file"_a, "buffer_size"_a = PythonStreamIn::cDefaultBufferSize,
+            "Args:\n"
+            "    file (object): Source to read from.\n"
+            "    buffer_size (int): Size of the read ahead buffer in bytes.")
+        .def("is_eof", &PythonStreamIn::IsEOF)
+        .def("is_failed", &PythonStreamIn::IsFailed);
+}
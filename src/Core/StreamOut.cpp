@@ -2,11 +2,58 @@
 #include <Jolt/Core/StreamOut.h>
 #include <BindingUtility/Stream.h>
 
-PythonStreamOut::PythonStreamOut(nb::object py_io_object) : m_py_io(py_io_object) {
+#ifndef JPH_PLATFORM_WINDOWS
+    #include <unistd.h>
+    #include <errno.h>
+#endif
 
-    if (!nb::hasattr(m_py_io, "write")) {
+#ifndef JPH_PLATFORM_WINDOWS
+// Only binary files are written through their file descriptor, text files encode and translate newlines in write
+static bool IsBinaryFile(nb::handle inFile) {
+    if (!nb::hasattr(inFile, "fileno"))
+        return false;
+    nb::module_ io = nb::module_::import_("io");
+    nb::object binary_types = nb::make_tuple(io.attr("BufferedIOBase"), io.attr("RawIOBase"));
+    int result = PyObject_IsInstance(inFile.ptr(), binary_types.ptr());
+    if (result < 0)
+        PyErr_Clear();
+    return result == 1;
+}
+#endif
+
+PythonStreamOut::PythonStreamOut(nb::object py_io_object, size_t buffer_size) : m_py_io(py_io_object) {
+
+    if (PyByteArray_Check(m_py_io.ptr()))
+        m_target = ETarget::ByteArray;
+#ifndef JPH_PLATFORM_WINDOWS
+    else if (buffer_size > 0 && IsBinaryFile(m_py_io)) {
+        // Write to the file descriptor directly at the position of the file object, the position is updated on flush so this is only
+        // done for buffered streams, which have to be flushed anyway
+        try {
+            int fd = nb::cast<int>(m_py_io.attr("fileno")());
+            m_py_io.attr("flush")();
+            int64 offset = nb::cast<int64>(m_py_io.attr("tell")());
+            if (lseek(fd, 0, SEEK_CUR) != -1) {
+                m_fd = fd;
+                m_fd_offset = offset;
+                m_target = ETarget::FileDescriptor;
+            }
+        } catch (const nb::python_error &) {
+            // E.g. io.BytesIO raises UnsupportedOperation, use write instead
+        } catch (const nb::cast_error &) {
+        }
+    }
+#endif
+
+    if (m_target == ETarget::Write && !nb::hasattr(m_py_io, "write")) {
         throw nb::type_error("Object provided to StreamOut must have a 'write' method that accepts bytes.");
     }
+
+    m_buffer.resize(buffer_size);
+}
+
+PythonStreamOut::~PythonStreamOut() {
+    Flush();
 }
 
 void PythonStreamOut::WriteBytes(const void *inData, size_t inNumBytes) {
@@ -14,12 +61,98 @@ void PythonStreamOut::WriteBytes(const void *inData, size_t inNumBytes) {
     if (m_failed)
         return;
 
-    try {
-        nb::bytes data_view(inData, inNumBytes);
+    if (m_buffer_used + inNumBytes <= m_buffer.size()) {
+        memcpy(m_buffer.data() + m_buffer_used, inData, inNumBytes);
+        m_buffer_used += inNumBytes;
+        return;
+    }
+
+    FlushBuffer();
+
+    // Large writes bypass the buffer
+    if (inNumBytes >= m_buffer.size())
+        WriteThrough(inData, inNumBytes);
+    else {
+        memcpy(m_buffer.data(), inData, inNumBytes);
+        m_buffer_used = inNumBytes;
+    }
+}
 
-        m_py_io.attr("write")(data_view);
+bool PythonStreamOut::Flush() {
+    FlushBuffer();
+
+    // pwrite does not move the file position, move the file object past the data so Python sees it after a flush
+    if (m_target == ETarget::FileDescriptor) {
+        nb::gil_scoped_acquire gil;
+        try {
+            m_py_io.attr("seek")(m_fd_offset);
+        } catch (const nb::python_error &) {
+            m_failed = true;
+        }
+    }
+    return !m_failed;
+}
+
+void PythonStreamOut::FlushBuffer() {
+    if (m_buffer_used > 0 && !m_failed)
+        WriteThrough(m_buffer.data(), m_buffer_used);
+    m_buffer_used = 0;
+}
+
+void PythonStreamOut::WriteThrough(const void *inData, size_t inNumBytes) {
+    const char *data = static_cast<const char *>(inData);
+
+#ifndef JPH_PLATFORM_WINDOWS
+    if (m_target == ETarget::FileDescriptor) {
+        while (inNumBytes > 0) {
+            ssize_t written = pwrite(m_fd, data, inNumBytes, m_fd_offset);
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0) {
+                m_failed = true;
+                return;
+            }
+            data += written;
+            inNumBytes -= size_t(written);
+            m_fd_offset += written;
+        }
+        return;
+    }
+#endif
+
+    // The stream can be used by code that released the GIL
+    nb::gil_scoped_acquire gil;
+
+    if (m_target == ETarget::ByteArray) {
+        Py_ssize_t old_size = PyByteArray_GET_SIZE(m_py_io.ptr());
+        if (PyByteArray_Resize(m_py_io.ptr(), old_size + Py_ssize_t(inNumBytes)) != 0) {
+            PyErr_Clear();
+            m_failed = true;
+            return;
+        }
+        memcpy(PyByteArray_AS_STRING(m_py_io.ptr()) + old_size, data, inNumBytes);
+        return;
+    }
+
+    try {
+        // Hand out a view of our memory instead of copying it into a bytes object, raw files may write partially
+        while (inNumBytes > 0) {
+            nb::object view = nb::steal(PyMemoryView_FromMemory(const_cast<char *>(data), Py_ssize_t(inNumBytes), PyBUF_READ));
+            if (!view.is_valid())
+                throw nb::python_error();
+            nb::object result = m_py_io.attr("write")(view);
+            size_t written = result.is_none() ? inNumBytes : nb::cast<size_t>(result);
+            if (written == 0) {
+                m_failed = true;
+                return;
+            }
+            data += written;
+            inNumBytes -= written;
+        }
     } catch (const nb::python_error &e) {
         m_failed = true;
+    } catch (const nb::cast_error &e) {
+        m_failed = true;
     }
 }
 
@@ -29,4 +162,17 @@ bool PythonStreamOut::IsFailed() const {
 
 void BindStreamOut(nb::module_ &m) {
     nb::class_<StreamOut, NonCopyable>(m, "StreamOut", "Simple binary output stream");
-}
\ No newline at end of file
+
+    nb::class_<PythonStreamOut, StreamOut>(m, "PythonStreamOut",
+        "StreamOut that writes to a Python object with a write method, a bytearray or a file.\n"
+        "Writes go straight to the target unless a buffer_size is given, a buffered stream must be flushed (or dropped) before the target object is used.")
+        .def(nb::init<nb::object, size_t>(), "file"_a, "buffer_size"_a = PythonStreamOut::cDefaultBufferSize,
+            "Args:\n"
+            "    file (object): bytearray (appended to), file opened in binary mode or object with a write method.\n"
+            "    buffer_size (int): Size of the write buffer in bytes, 0 writes through. Buffering (e.g. 65536) is much faster for files and objects with a write method, files opened in binary mode are then written through their file descriptor without the GIL.")
+        .def("flush", &PythonStreamOut::Flush, nb::call_guard<nb::gil_scoped_release>(),
+            "Write the buffered data to the target.\n"
+            "Returns:\n"
+            "    bool: False if the stream failed.")
+        .def("is_failed", &PythonStreamOut::IsFailed);
+}
@@ -18,16 +18,16 @@ void BindBroadPhaseQuery(nb::module_ &m) {
 
         // TODO: default values = bad cast
     broadPhaseQueryCls
-        .def("cast_ray", &BroadPhaseQuery::CastRay, "ray"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a,
+        .def("cast_ray", &BroadPhaseQuery::CastRay, "ray"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Cast a ray and add any hits to ioCollector")
-        .def("collide_aa_box", &BroadPhaseQuery::CollideAABox, "box"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a,
+        .def("collide_aa_box", &BroadPhaseQuery::CollideAABox, "box"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Get bodies intersecting with inBox and any hits to ioCollector")
-        .def("collide_sphere", &BroadPhaseQuery::CollideSphere, "center"_a, "radius"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a,
+        .def("collide_sphere", &BroadPhaseQuery::CollideSphere, "center"_a, "radius"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Get bodies intersecting with a sphere and any hits to ioCollector")
-        .def("collide_point", &BroadPhaseQuery::CollidePoint, "point"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a,
+        .def("collide_point", &BroadPhaseQuery::CollidePoint, "point"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Get bodies intersecting with a point and any hits to ioCollector")
-        .def("collide_oriented_box", &BroadPhaseQuery::CollideOrientedBox, "box"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a,
+        .def("collide_oriented_box", &BroadPhaseQuery::CollideOrientedBox, "box"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Get bodies intersecting with an oriented box and any hits to ioCollector")
-        .def("cast_aa_box", &BroadPhaseQuery::CastAABox, "box"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a,
+        .def("cast_aa_box", &BroadPhaseQuery::CastAABox, "box"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Cast a box and add any hits to ioCollector");
 }
\ No newline at end of file
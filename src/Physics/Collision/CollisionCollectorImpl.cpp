@@ -5,21 +5,276 @@
 #include <Jolt/Physics/Collision/Shape/Shape.h>
 #include <Jolt/Physics/Collision/ShapeCast.h>
 #include <Jolt/Physics/Collision/CastResult.h>
+#include <Jolt/Physics/Collision/CollidePointResult.h>
+#include <Jolt/Physics/Collision/TransformedShape.h>
+#include <Jolt/Physics/Collision/BroadPhase/BroadPhaseQuery.h>
+#include "BindingUtility/StructuredArray.h"
+#include <algorithm>
+
+/// Collects the inMaxHits closest / deepest hits. Once the collector is full the early out fraction is
+/// lowered to the furthest collected hit, so the query can skip everything that would not make the cut.
+template <class CollectorType>
+class KNearestCollisionCollector : public CollectorType {
+  public:
+    using ResultType = typename CollectorType::ResultType;
+
+    explicit KNearestCollisionCollector(uint inMaxHits) :
+        mMaxHits(max(inMaxHits, 1U)) {
+    }
+
+    virtual void Reset() override {
+        CollectorType::Reset();
+        mHits.clear();
+        mIsHeap = true;
+    }
+
+    virtual void AddHit(const ResultType &inResult) override {
+        if (!mIsHeap) {
+            std::make_heap(mHits.begin(), mHits.end(), sCloser);
+            mIsHeap = true;
+        }
+
+        if (mHits.size() < mMaxHits) {
+            mHits.push_back(inResult);
+            std::push_heap(mHits.begin(), mHits.end(), sCloser);
+        } else if (inResult.GetEarlyOutFraction() < mHits.front().GetEarlyOutFraction()) {
+            std::pop_heap(mHits.begin(), mHits.end(), sCloser);
+            mHits.back() = inResult;
+            std::push_heap(mHits.begin(), mHits.end(), sCloser);
+        } else
+            return;
+
+        // The root of the heap is the furthest hit we still keep
+        if (mHits.size() == mMaxHits)
+            this->UpdateEarlyOutFraction(mHits.front().GetEarlyOutFraction());
+    }
+
+    /// Order hits on closest first
+    void Sort() {
+        if (mIsHeap) {
+            std::sort_heap(mHits.begin(), mHits.end(), sCloser);
+            mIsHeap = false;
+        }
+    }
+
+    /// Check if any hits were collected
+    inline bool HadHit() const {
+        return !mHits.empty();
+    }
+
+    Array<ResultType> mHits;
+    uint mMaxHits;
+
+  private:
+    static bool sCloser(const ResultType &inLHS, const ResultType &inRHS) {
+        return inLHS.GetEarlyOutFraction() < inRHS.GetEarlyOutFraction();
+    }
+
+    bool mIsHeap = true;
+};
+
+/// Flat record that a hit of type ResultType is exported to, cOrdered tells if the hits can be ordered by GetEarlyOutFraction
+template <class ResultType>
+struct HitRecord;
+
+template <>
+struct HitRecord<RayCastResult> {
+    static constexpr bool cOrdered = true;
+
+    explicit HitRecord(const RayCastResult &inHit) :
+        mBodyID(inHit.mBodyID.GetIndexAndSequenceNumber()),
+        mSubShapeID2(inHit.mSubShapeID2.GetValue()),
+        mFraction(inHit.mFraction) {
+    }
+
+    static Array<RecordField> sGetFields() {
+        return { { "body_id", "<u4", 1, offsetof(HitRecord, mBodyID) },
+                 { "sub_shape_id2", "<u4", 1, offsetof(HitRecord, mSubShapeID2) },
+                 { "fraction", "<f4", 1, offsetof(HitRecord, mFraction) } };
+    }
+
+    uint32 mBodyID;
+    uint32 mSubShapeID2;
+    float mFraction;
+};
+
+template <>
+struct HitRecord<BroadPhaseCastResult> {
+    static constexpr bool cOrdered = true;
+
+    explicit HitRecord(const BroadPhaseCastResult &inHit) :
+        mBodyID(inHit.mBodyID.GetIndexAndSequenceNumber()),
+        mFraction(inHit.mFraction) {
+    }
+
+    static Array<RecordField> sGetFields() {
+        return { { "body_id", "<u4", 1, offsetof(HitRecord, mBodyID) },
+                 { "fraction", "<f4", 1, offsetof(HitRecord, mFraction) } };
+    }
+
+    uint32 mBodyID;
+    float mFraction;
+};
+
+/// A point is either inside a shape or not, the early out fraction of every hit is 0 so there is nothing to order on
+template <>
+struct HitRecord<CollidePointResult> {
+    static constexpr bool cOrdered = false;
+
+    explicit HitRecord(const CollidePointResult &inHit) :
+        mBodyID(inHit.mBodyID.GetIndexAndSequenceNumber()),
+        mSubShapeID2(inHit.mSubShapeID2.GetValue()) {
+    }
+
+    static Array<RecordField> sGetFields() {
+        return { { "body_id", "<u4", 1, offsetof(HitRecord, mBodyID) },
+                 { "sub_shape_id2", "<u4", 1, offsetof(HitRecord, mSubShapeID2) } };
+    }
+
+    uint32 mBodyID;
+    uint32 mSubShapeID2;
+};
+
+template <>
+struct HitRecord<BodyID> {
+    static constexpr bool cOrdered = false;
+
+    explicit HitRecord(const BodyID &inHit) :
+        mBodyID(inHit.GetIndexAndSequenceNumber()) {
+    }
+
+    static Array<RecordField> sGetFields() {
+        return { { "body_id", "<u4", 1, offsetof(HitRecord, mBodyID) } };
+    }
+
+    uint32 mBodyID;
+};
+
+template <>
+struct HitRecord<CollideShapeResult> {
+    static constexpr bool cOrdered = true;
+
+    explicit HitRecord(const CollideShapeResult &inHit) :
+        mPenetrationDepth(inHit.mPenetrationDepth),
+        mSubShapeID1(inHit.mSubShapeID1.GetValue()),
+        mSubShapeID2(inHit.mSubShapeID2.GetValue()),
+        mBodyID2(inHit.mBodyID2.GetIndexAndSequenceNumber()) {
+        inHit.mContactPointOn1.StoreFloat3(&mContactPointOn1);
+        inHit.mContactPointOn2.StoreFloat3(&mContactPointOn2);
+        inHit.mPenetrationAxis.StoreFloat3(&mPenetrationAxis);
+    }
+
+    static Array<RecordField> sGetFields() {
+        return { { "contact_point_on1", "<f4", 3, offsetof(HitRecord, mContactPointOn1) },
+                 { "contact_point_on2", "<f4", 3, offsetof(HitRecord, mContactPointOn2) },
+                 { "penetration_axis", "<f4", 3, offsetof(HitRecord, mPenetrationAxis) },
+                 { "penetration_depth", "<f4", 1, offsetof(HitRecord, mPenetrationDepth) },
+                 { "sub_shape_id1", "<u4", 1, offsetof(HitRecord, mSubShapeID1) },
+                 { "sub_shape_id2", "<u4", 1, offsetof(HitRecord, mSubShapeID2) },
+                 { "body_id2", "<u4", 1, offsetof(HitRecord, mBodyID2) } };
+    }
+
+    Float3 mContactPointOn1;
+    Float3 mContactPointOn2;
+    Float3 mPenetrationAxis;
+    float mPenetrationDepth;
+    uint32 mSubShapeID1;
+    uint32 mSubShapeID2;
+    uint32 mBodyID2;
+};
+
+template <>
+struct HitRecord<ShapeCastResult> {
+    static constexpr bool cOrdered = true;
+
+    explicit HitRecord(const ShapeCastResult &inHit) :
+        mPenetrationDepth(inHit.mPenetrationDepth),
+        mSubShapeID1(inHit.mSubShapeID1.GetValue()),
+        mSubShapeID2(inHit.mSubShapeID2.GetValue()),
+        mBodyID2(inHit.mBodyID2.GetIndexAndSequenceNumber()),
+        mFraction(inHit.mFraction),
+        mIsBackFaceHit(inHit.mIsBackFaceHit) {
+        inHit.mContactPointOn1.StoreFloat3(&mContactPointOn1);
+        inHit.mContactPointOn2.StoreFloat3(&mContactPointOn2);
+        inHit.mPenetrationAxis.StoreFloat3(&mPenetrationAxis);
+    }
+
+    static Array<RecordField> sGetFields() {
+        return { { "contact_point_on1", "<f4", 3, offsetof(HitRecord, mContactPointOn1) },
+                 { "contact_point_on2", "<f4", 3, offsetof(HitRecord, mContactPointOn2) },
+                 { "penetration_axis", "<f4", 3, offsetof(HitRecord, mPenetrationAxis) },
+                 { "penetration_depth", "<f4", 1, offsetof(HitRecord, mPenetrationDepth) },
+                 { "sub_shape_id1", "<u4", 1, offsetof(HitRecord, mSubShapeID1) },
+                 { "sub_shape_id2", "<u4", 1, offsetof(HitRecord, mSubShapeID2) },
+                 { "body_id2", "<u4", 1, offsetof(HitRecord, mBodyID2) },
+                 { "fraction", "<f4", 1, offsetof(HitRecord, mFraction) },
+                 { "is_back_face_hit", "?", 1, offsetof(HitRecord, mIsBackFaceHit) } };
+    }
+
+    Float3 mContactPointOn1;
+    Float3 mContactPointOn2;
+    Float3 mPenetrationAxis;
+    float mPenetrationDepth;
+    uint32 mSubShapeID1;
+    uint32 mSubShapeID2;
+    uint32 mBodyID2;
+    float mFraction;
+    bool mIsBackFaceHit;
+};
+
+template <>
+struct HitRecord<TransformedShape> {
+    static constexpr bool cOrdered = false;
+
+    explicit HitRecord(const TransformedShape &inHit) :
+        mBodyID(inHit.mBodyID.GetIndexAndSequenceNumber()) {
+        inHit.GetShapeScale().StoreFloat3(&mShapeScale);
+        RVec3 position = inHit.mShapePositionCOM;
+        for (int c = 0; c < 3; ++c)
+            mShapePositionCOM[c] = position[c];
+        inHit.mShapeRotation.GetXYZW().StoreFloat4(&mShapeRotation);
+    }
+
+    static Array<RecordField> sGetFields() {
+        return { { "shape_position_com", cRealFormat, 3, offsetof(HitRecord, mShapePositionCOM) },
+                 { "shape_rotation", "<f4", 4, offsetof(HitRecord, mShapeRotation) },
+                 { "shape_scale", "<f4", 3, offsetof(HitRecord, mShapeScale) },
+                 { "body_id", "<u4", 1, offsetof(HitRecord, mBodyID) } };
+    }
+
+    Real mShapePositionCOM[3];
+    Float4 mShapeRotation;
+    Float3 mShapeScale;
+    uint32 mBodyID;
+};
+
+/// Export inCount hits to a NumPy array with a structured dtype, one record per hit
+template <class ResultType>
+static nb::object HitsToNumpy(const ResultType *inHits, size_t inCount) {
+    return RecordsToNumpy<HitRecord<ResultType>>(inHits, inCount);
+}
 
 template <class CollectorType>
 static void BindAllHitCollisionCollector(nb::module_ &m, const char *name) {
     using CurrentInst = AllHitCollisionCollector<CollectorType>;
+    using ResultType = typename CollectorType::ResultType;
     nb::class_<CurrentInst, CollectorType> allHitCollisionCollectorCls(m, name,
         "Simple implementation that collects all hits and optionally sorts them on distance");
     allHitCollisionCollectorCls
         .def(nb::init<>())
         .def("reset", &CurrentInst::Reset)
         .def("add_hit", &CurrentInst::AddHit, "result"_a)
-        .def("sort", &CurrentInst::Sort,
-            "Order hits on closest first")
         .def("had_hit", &CurrentInst::HadHit,
             "Check if any hits were collected")
-        .def_rw("hits", &CurrentInst::mHits);
+        .def_rw("hits", &CurrentInst::mHits)
+        .def("to_numpy", [](const CurrentInst &self) {
+            return HitsToNumpy(self.mHits.data(), self.mHits.size());
+        }, "Copy the collected hits to a NumPy array with a structured dtype, one record per hit in the order they are stored");
+
+    if constexpr (HitRecord<ResultType>::cOrdered)
+        allHitCollisionCollectorCls
+            .def("sort", &CurrentInst::Sort,
+                "Order hits on closest first");
 }
 
 template <class CollectorType>
@@ -33,7 +288,10 @@ static void BindClosestHitCollisionCollector(nb::module_ &m, const char *name) {
         .def("add_hit", &CurrentInst::AddHit, "result"_a)
         .def("had_hit", &CurrentInst::HadHit,
             "Check if this collector has had a hit")
-        .def_rw("hit", &CurrentInst::mHit);
+        .def_rw("hit", &CurrentInst::mHit)
+        .def("to_numpy", [](const CurrentInst &self) {
+            return HitsToNumpy(&self.mHit, self.HadHit() ? 1 : 0);
+        }, "Copy the hit to a NumPy array with a structured dtype, the array is empty if there was no hit");
 }
 
 template <class CollectorType>
@@ -47,13 +305,51 @@ static void BindAnyHitCollisionCollector(nb::module_ &m, const char *name) {
         .def("add_hit", &CurrentInst::AddHit, "result"_a)
         .def("had_hit", &CurrentInst::HadHit,
             "Check if this collector has had a hit")
-        .def_rw("hit", &CurrentInst::mHit);
+        .def_rw("hit", &CurrentInst::mHit)
+        .def("to_numpy", [](const CurrentInst &self) {
+            return HitsToNumpy(&self.mHit, self.HadHit() ? 1 : 0);
+        }, "Copy the hit to a NumPy array with a structured dtype, the array is empty if there was no hit");
 }
 
-void BindCollisionCollectorImpl(nb::module_ &m) {
-    BindAllHitCollisionCollector<CastShapeCollector>(m, "AllHitCollisionCollector_CastShapeCollector");
+template <class CollectorType>
+static void BindKNearestCollisionCollector(nb::module_ &m, const char *name) {
+    using CurrentInst = KNearestCollisionCollector<CollectorType>;
+    nb::class_<CurrentInst, CollectorType> kNearestCollisionCollectorCls(m, name,
+        "Collects the max_hits closest / deepest hits, once full the early out fraction is lowered so the query skips hits that would not make the cut");
+    kNearestCollisionCollectorCls
+        .def(nb::init<uint>(), "max_hits"_a)
+        .def("reset", &CurrentInst::Reset)
+        .def("add_hit", &CurrentInst::AddHit, "result"_a)
+        .def("sort", &CurrentInst::Sort,
+            "Order hits on closest first")
+        .def("had_hit", &CurrentInst::HadHit,
+            "Check if any hits were collected")
+        .def_ro("max_hits", &CurrentInst::mMaxHits)
+        .def_ro("hits", &CurrentInst::mHits)
+        .def("to_numpy", [](CurrentInst &self) {
+            self.Sort();
+            return HitsToNumpy(self.mHits.data(), self.mHits.size());
+        }, "Copy the collected hits to a NumPy array with a structured dtype, one record per hit ordered closest first");
+}
 
-    BindClosestHitCollisionCollector<CastShapeCollector>(m, "ClosestHitCollisionCollector_CastShapeCollector");
+/// Bind the native collectors for CollectorType, collectors that need to order hits are only bound for results that can be ordered
+template <class CollectorType>
+static void BindNativeCollisionCollectors(nb::module_ &m, const std::string &name) {
+    BindAllHitCollisionCollector<CollectorType>(m, ("AllHitCollisionCollector_" + name).c_str());
+    BindAnyHitCollisionCollector<CollectorType>(m, ("AnyHitCollisionCollector_" + name).c_str());
+    if constexpr (HitRecord<typename CollectorType::ResultType>::cOrdered) {
+        BindClosestHitCollisionCollector<CollectorType>(m, ("ClosestHitCollisionCollector_" + name).c_str());
+        BindKNearestCollisionCollector<CollectorType>(m, ("KNearestCollisionCollector_" + name).c_str());
+    }
+}
 
-    BindAnyHitCollisionCollector<CastShapeCollector>(m, "AnyHitCollisionCollector_CastShapeCollector");
+void BindCollisionCollectorImpl(nb::module_ &m) {
+    BindNativeCollisionCollectors<CastRayCollector>(m, "CastRayCollector");
+    BindNativeCollisionCollectors<CastShapeCollector>(m, "CastShapeCollector");
+    BindNativeCollisionCollectors<CollideShapeCollector>(m, "CollideShapeCollector");
+    BindNativeCollisionCollectors<CollidePointCollector>(m, "CollidePointCollector");
+    BindNativeCollisionCollectors<RayCastBodyCollector>(m, "RayCastBodyCollector");
+    BindNativeCollisionCollectors<CastShapeBodyCollector>(m, "CastShapeBodyCollector");
+    BindNativeCollisionCollectors<CollideShapeBodyCollector>(m, "CollideShapeBodyCollector");
+    BindNativeCollisionCollectors<TransformedShapeCollector>(m, "TransformedShapeCollector");
 }
\ No newline at end of file
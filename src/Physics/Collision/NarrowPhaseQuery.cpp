@@ -3,6 +3,327 @@
 #include <Jolt/Physics/Collision/ShapeCast.h>
 #include <Jolt/Physics/Collision/RayCast.h>
 #include <Jolt/Physics/Collision/CastResult.h>
+#include <Jolt/Physics/Collision/TransformedShape.h>
+#include <Jolt/Physics/Collision/CollideShape.h>
+#include <Jolt/Physics/Collision/CollisionCollectorImpl.h>
+#include <Jolt/Geometry/MortonCode.h>
+#include <Jolt/Core/QuickSort.h>
+#include "BindingUtility/NumpyRows.h"
+#include "BindingUtility/ParallelFor.h"
+
+/// Filters of a batched query, a filter that was passed as None is replaced by one that accepts everything
+struct BatchQueryFilters {
+    BatchQueryFilters(const BroadPhaseLayerFilter *inBroadPhaseLayerFilter, const ObjectLayerFilter *inObjectLayerFilter, const BodyFilter *inBodyFilter, const ShapeFilter *inShapeFilter) :
+        mBroadPhaseLayerFilter(inBroadPhaseLayerFilter != nullptr ? *inBroadPhaseLayerFilter : mDefaultBroadPhaseLayerFilter),
+        mObjectLayerFilter(inObjectLayerFilter != nullptr ? *inObjectLayerFilter : mDefaultObjectLayerFilter),
+        mBodyFilter(inBodyFilter != nullptr ? *inBodyFilter : mDefaultBodyFilter),
+        mShapeFilter(inShapeFilter != nullptr ? *inShapeFilter : mDefaultShapeFilter) {
+    }
+
+  private:
+    BroadPhaseLayerFilter mDefaultBroadPhaseLayerFilter;
+    ObjectLayerFilter mDefaultObjectLayerFilter;
+    BodyFilter mDefaultBodyFilter;
+    ShapeFilter mDefaultShapeFilter;
+
+  public:
+    const BroadPhaseLayerFilter &mBroadPhaseLayerFilter;
+    const ObjectLayerFilter &mObjectLayerFilter;
+    const BodyFilter &mBodyFilter;
+    const ShapeFilter &mShapeFilter;
+};
+
+/// Collector for cast_rays, keeps the closest (or the first) hit and calculates its normal while the body is locked
+class BatchRayCastCollector : public CastRayCollector {
+  public:
+    BatchRayCastCollector(const RRayCast &inRay, bool inAnyHit, bool inCalculateNormal) :
+        mRay(inRay),
+        mAnyHit(inAnyHit),
+        mCalculateNormal(inCalculateNormal) {
+    }
+
+    virtual void AddHit(const RayCastResult &inResult) override {
+        if (inResult.mFraction >= GetEarlyOutFraction())
+            return;
+
+        mHit = inResult;
+        mHadHit = true;
+        if (mCalculateNormal)
+            mNormal = GetContext()->GetWorldSpaceSurfaceNormal(inResult.mSubShapeID2, mRay.GetPointOnRay(inResult.mFraction));
+
+        if (mAnyHit)
+            ForceEarlyOut();
+        else
+            UpdateEarlyOutFraction(inResult.mFraction);
+    }
+
+    const RRayCast &mRay;
+    bool mAnyHit;
+    bool mCalculateNormal;
+    bool mHadHit = false;
+    RayCastResult mHit;
+    Vec3 mNormal = Vec3::sZero();
+};
+
+/// Cast a batch of rays on the job system, see the cast_rays docstring
+static nb::dict CastRays(const NarrowPhaseQuery &inQuery, const NumpyRows<3> &inOrigins, const NumpyRows<3> &inDirections, JobSystem *inJobSystem, bool inAnyHit, bool inCalculateNormals, bool inSortRays,
+                         const RayCastSettings *inSettings, const BroadPhaseLayerFilter *inBroadPhaseLayerFilter, const ObjectLayerFilter *inObjectLayerFilter, const BodyFilter *inBodyFilter, const ShapeFilter *inShapeFilter) {
+    constexpr size_t cRaysPerBatch = 128;
+
+    size_t num_rays = inOrigins.shape(0);
+    NumpyRowReader<3> origins(inOrigins, num_rays, "origins");
+    NumpyRowReader<3> directions(inDirections, num_rays, "directions");
+
+    auto hits = AllocateNumpyArray<bool>({ num_rays });
+    auto fractions = AllocateNumpyArray<float>({ num_rays });
+    auto body_ids = AllocateNumpyArray<uint32>({ num_rays });
+    auto sub_shape_ids = AllocateNumpyArray<uint32>({ num_rays });
+    nb::ndarray<nb::numpy, float> normals;
+    if (inCalculateNormals)
+        normals = AllocateNumpyArray<float>({ num_rays, 3 });
+
+    {
+        nb::gil_scoped_release release;
+
+        RayCastSettings default_settings;
+        const RayCastSettings &settings = inSettings != nullptr ? *inSettings : default_settings;
+        BatchQueryFilters filters(inBroadPhaseLayerFilter, inObjectLayerFilter, inBodyFilter, inShapeFilter);
+
+        // Visit the rays in Morton order of their origin so that consecutive rays touch the same broadphase nodes and bodies
+        Array<uint64> order(num_rays);
+        if (inSortRays) {
+            AABox bounds;
+            for (size_t i = 0; i < num_rays; ++i)
+                bounds.Encapsulate(origins.LoadVec3(i));
+            bounds.EnsureMinimalEdgeLength(1.0e-3f);
+            for (size_t i = 0; i < num_rays; ++i)
+                order[i] = (uint64(MortonCode::sGetMortonCode(origins.LoadVec3(i), bounds)) << 32) | uint64(i);
+            QuickSort(order.begin(), order.end());
+        } else {
+            for (size_t i = 0; i < num_rays; ++i)
+                order[i] = uint64(i);
+        }
+
+        ParallelFor(inJobSystem, num_rays, cRaysPerBatch, [&](size_t inBegin, size_t inEnd) {
+            for (size_t r = inBegin; r < inEnd; ++r) {
+                size_t i = size_t(order[r] & 0xffffffff);
+                RRayCast ray(origins.LoadRVec3(i), directions.LoadVec3(i));
+                BatchRayCastCollector collector(ray, inAnyHit, inCalculateNormals);
+                inQuery.CastRay(ray, settings, collector, filters.mBroadPhaseLayerFilter, filters.mObjectLayerFilter, filters.mBodyFilter, filters.mShapeFilter);
+
+                hits.data()[i] = collector.mHadHit;
+                fractions.data()[i] = collector.mHadHit ? collector.mHit.mFraction : FLT_MAX;
+                body_ids.data()[i] = collector.mHadHit ? collector.mHit.mBodyID.GetIndexAndSequenceNumber() : BodyID::cInvalidBodyID;
+                sub_shape_ids.data()[i] = collector.mHadHit ? collector.mHit.mSubShapeID2.GetValue() : SubShapeID().GetValue();
+                if (inCalculateNormals)
+                    collector.mNormal.StoreFloat3(reinterpret_cast<Float3 *>(normals.data() + i * 3));
+            }
+        });
+    }
+
+    nb::dict result;
+    result["hit"] = hits;
+    result["fraction"] = fractions;
+    result["body_id"] = body_ids;
+    result["sub_shape_id"] = sub_shape_ids;
+    if (inCalculateNormals)
+        result["normal"] = normals;
+    return result;
+}
+
+/// Hit of cast_shapes / collide_shapes with the contact points in world space
+struct BatchShapeHit {
+    RVec3 mContactPointOn1;
+    RVec3 mContactPointOn2;
+    Vec3 mPenetrationAxis;
+    float mPenetrationDepth;
+    float mFraction;
+    uint32 mBodyID;
+    uint32 mSubShapeID1;
+    uint32 mSubShapeID2;
+    bool mIsBackFaceHit;
+};
+
+static void AddBatchShapeHit(Array<BatchShapeHit> &ioHits, const CollideShapeResult &inResult, RVec3Arg inBaseOffset, float inFraction = 0.0f, bool inIsBackFaceHit = false) {
+    BatchShapeHit &hit = ioHits.emplace_back();
+    hit.mContactPointOn1 = inBaseOffset + inResult.mContactPointOn1;
+    hit.mContactPointOn2 = inBaseOffset + inResult.mContactPointOn2;
+    hit.mPenetrationAxis = inResult.mPenetrationAxis;
+    hit.mPenetrationDepth = inResult.mPenetrationDepth;
+    hit.mFraction = inFraction;
+    hit.mBodyID = inResult.mBodyID2.GetIndexAndSequenceNumber();
+    hit.mSubShapeID1 = inResult.mSubShapeID1.GetValue();
+    hit.mSubShapeID2 = inResult.mSubShapeID2.GetValue();
+    hit.mIsBackFaceHit = inIsBackFaceHit;
+}
+
+static void AddBatchShapeHit(Array<BatchShapeHit> &ioHits, const ShapeCastResult &inResult, RVec3Arg inBaseOffset) {
+    AddBatchShapeHit(ioHits, inResult, inBaseOffset, inResult.mFraction, inResult.mIsBackFaceHit);
+}
+
+/// Input of cast_shapes / collide_shapes: one body transform, scale and shape per query
+class BatchShapeQueryInput {
+  public:
+    BatchShapeQueryInput(nb::handle inShapes, const NumpyRows<3> &inPositions, const NumpyRows<4> &inRotations, const NumpyRows<3> &inScales) :
+        mNumQueries(inPositions.shape(0)),
+        mPositions(inPositions, mNumQueries, "positions"),
+        mRotations(inRotations, mNumQueries, "rotations"),
+        mScales(inScales, mNumQueries, "scales") {
+        if (nb::isinstance<Shape>(inShapes)) {
+            mShapes.push_back(nb::cast<const Shape *>(inShapes));
+        } else {
+            for (nb::handle shape : inShapes)
+                mShapes.push_back(nb::cast<const Shape *>(shape));
+            if (mShapes.size() != mNumQueries)
+                throw nb::value_error(("shapes: expected a Shape or a sequence of " + std::to_string(mNumQueries) + " shapes, got " + std::to_string(mShapes.size())).c_str());
+        }
+    }
+
+    inline const Shape *GetShape(size_t inQuery) const {
+        return mShapes[mShapes.size() == 1 ? 0 : inQuery];
+    }
+
+    inline RMat44 GetTransform(size_t inQuery) const {
+        return RMat44::sRotationTranslation(mRotations.IsEnabled() ? mRotations.LoadQuat(inQuery) : Quat::sIdentity(), mPositions.LoadRVec3(inQuery));
+    }
+
+    inline Vec3 GetScale(size_t inQuery) const {
+        return mScales.IsEnabled() ? mScales.LoadVec3(inQuery) : Vec3::sOne();
+    }
+
+    size_t mNumQueries;
+
+  private:
+    NumpyRowReader<3> mPositions;
+    NumpyRowReader<4> mRotations;
+    NumpyRowReader<3> mScales;
+    Array<const Shape *> mShapes;
+};
+
+/// Run inQuery(query index, hits) for every query on the job system and return the hits in CSR layout
+template <class QueryFunction>
+static nb::dict RunBatchShapeQueries(size_t inNumQueries, JobSystem *inJobSystem, bool inCast, const QueryFunction &inQuery) {
+    constexpr size_t cQueriesPerBatch = 32;
+
+    // Every batch of queries appends to its own hit array, concatenating them in batch order keeps the hits in query order
+    Array<Array<BatchShapeHit>> batch_hits((inNumQueries + cQueriesPerBatch - 1) / cQueriesPerBatch);
+    Array<uint32> offsets(inNumQueries + 1, 0);
+    {
+        nb::gil_scoped_release release;
+
+        ParallelFor(inJobSystem, inNumQueries, cQueriesPerBatch, [&](size_t inBegin, size_t inEnd) {
+            Array<BatchShapeHit> &hits = batch_hits[inBegin / cQueriesPerBatch];
+            for (size_t i = inBegin; i < inEnd; ++i) {
+                size_t num_hits_before = hits.size();
+                inQuery(i, hits);
+                offsets[i + 1] = uint32(hits.size() - num_hits_before);
+            }
+        });
+
+        for (size_t i = 0; i < inNumQueries; ++i)
+            offsets[i + 1] += offsets[i];
+    }
+
+    size_t num_hits = offsets[inNumQueries];
+    auto offsets_out = AllocateNumpyArray<uint32>({ inNumQueries + 1 });
+    auto body_ids = AllocateNumpyArray<uint32>({ num_hits });
+    auto sub_shape_ids1 = AllocateNumpyArray<uint32>({ num_hits });
+    auto sub_shape_ids2 = AllocateNumpyArray<uint32>({ num_hits });
+    auto contact_points1 = AllocateNumpyArray<Real>({ num_hits, 3 });
+    auto contact_points2 = AllocateNumpyArray<Real>({ num_hits, 3 });
+    auto penetration_axes = AllocateNumpyArray<float>({ num_hits, 3 });
+    auto penetration_depths = AllocateNumpyArray<float>({ num_hits });
+    auto fractions = AllocateNumpyArray<float>({ num_hits });
+    auto back_faces = AllocateNumpyArray<bool>({ num_hits });
+
+    memcpy(offsets_out.data(), offsets.data(), offsets.size() * sizeof(uint32));
+    size_t h = 0;
+    for (const Array<BatchShapeHit> &hits : batch_hits)
+        for (const BatchShapeHit &hit : hits) {
+            body_ids.data()[h] = hit.mBodyID;
+            sub_shape_ids1.data()[h] = hit.mSubShapeID1;
+            sub_shape_ids2.data()[h] = hit.mSubShapeID2;
+            for (int c = 0; c < 3; ++c) {
+                contact_points1.data()[h * 3 + c] = hit.mContactPointOn1[c];
+                contact_points2.data()[h * 3 + c] = hit.mContactPointOn2[c];
+                penetration_axes.data()[h * 3 + c] = hit.mPenetrationAxis[c];
+            }
+            penetration_depths.data()[h] = hit.mPenetrationDepth;
+            fractions.data()[h] = hit.mFraction;
+            back_faces.data()[h] = hit.mIsBackFaceHit;
+            ++h;
+        }
+
+    nb::dict result;
+    result["offsets"] = offsets_out;
+    result["body_id"] = body_ids;
+    result["sub_shape_id1"] = sub_shape_ids1;
+    result["sub_shape_id2"] = sub_shape_ids2;
+    result["contact_point_on1"] = contact_points1;
+    result["contact_point_on2"] = contact_points2;
+    result["penetration_axis"] = penetration_axes;
+    result["penetration_depth"] = penetration_depths;
+    if (inCast) {
+        result["fraction"] = fractions;
+        result["is_back_face_hit"] = back_faces;
+    }
+    return result;
+}
+
+static nb::dict CastShapes(const NarrowPhaseQuery &inQuery, nb::handle inShapes, const NumpyRows<3> &inPositions, const NumpyRows<3> &inDirections, const NumpyRows<4> &inRotations, const NumpyRows<3> &inScales, JobSystem *inJobSystem, bool inAllHits,
+                           const ShapeCastSettings *inSettings, const BroadPhaseLayerFilter *inBroadPhaseLayerFilter, const ObjectLayerFilter *inObjectLayerFilter, const BodyFilter *inBodyFilter, const ShapeFilter *inShapeFilter) {
+    BatchShapeQueryInput input(inShapes, inPositions, inRotations, inScales);
+    NumpyRowReader<3> directions(inDirections, input.mNumQueries, "directions");
+    ShapeCastSettings default_settings;
+    const ShapeCastSettings &settings = inSettings != nullptr ? *inSettings : default_settings;
+    BatchQueryFilters filters(inBroadPhaseLayerFilter, inObjectLayerFilter, inBodyFilter, inShapeFilter);
+
+    return RunBatchShapeQueries(input.mNumQueries, inJobSystem, true, [&](size_t inIndex, Array<BatchShapeHit> &ioHits) {
+        RMat44 transform = input.GetTransform(inIndex);
+        RShapeCast shape_cast = RShapeCast::sFromWorldTransform(input.GetShape(inIndex), input.GetScale(inIndex), transform, directions.LoadVec3(inIndex));
+        RVec3 base_offset = transform.GetTranslation();
+        if (inAllHits) {
+            AllHitCollisionCollector<CastShapeCollector> collector;
+            inQuery.CastShape(shape_cast, settings, base_offset, collector, filters.mBroadPhaseLayerFilter, filters.mObjectLayerFilter, filters.mBodyFilter, filters.mShapeFilter);
+            collector.Sort();
+            for (const ShapeCastResult &hit : collector.mHits)
+                AddBatchShapeHit(ioHits, hit, base_offset);
+        } else {
+            ClosestHitCollisionCollector<CastShapeCollector> collector;
+            inQuery.CastShape(shape_cast, settings, base_offset, collector, filters.mBroadPhaseLayerFilter, filters.mObjectLayerFilter, filters.mBodyFilter, filters.mShapeFilter);
+            if (collector.HadHit())
+                AddBatchShapeHit(ioHits, collector.mHit, base_offset);
+        }
+    });
+}
+
+static nb::dict CollideShapes(const NarrowPhaseQuery &inQuery, nb::handle inShapes, const NumpyRows<3> &inPositions, const NumpyRows<4> &inRotations, const NumpyRows<3> &inScales, JobSystem *inJobSystem, bool inAllHits,
+                              const CollideShapeSettings *inSettings, const BroadPhaseLayerFilter *inBroadPhaseLayerFilter, const ObjectLayerFilter *inObjectLayerFilter, const BodyFilter *inBodyFilter, const ShapeFilter *inShapeFilter) {
+    BatchShapeQueryInput input(inShapes, inPositions, inRotations, inScales);
+    CollideShapeSettings default_settings;
+    const CollideShapeSettings &settings = inSettings != nullptr ? *inSettings : default_settings;
+    BatchQueryFilters filters(inBroadPhaseLayerFilter, inObjectLayerFilter, inBodyFilter, inShapeFilter);
+
+    return RunBatchShapeQueries(input.mNumQueries, inJobSystem, false, [&](size_t inIndex, Array<BatchShapeHit> &ioHits) {
+        const Shape *shape = input.GetShape(inIndex);
+        Vec3 scale = input.GetScale(inIndex);
+        RMat44 transform = input.GetTransform(inIndex);
+        RMat44 center_of_mass_transform = transform.PreTranslated(scale * shape->GetCenterOfMass());
+        RVec3 base_offset = transform.GetTranslation();
+        if (inAllHits) {
+            AllHitCollisionCollector<CollideShapeCollector> collector;
+            inQuery.CollideShape(shape, scale, center_of_mass_transform, settings, base_offset, collector, filters.mBroadPhaseLayerFilter, filters.mObjectLayerFilter, filters.mBodyFilter, filters.mShapeFilter);
+            collector.Sort();
+            for (const CollideShapeResult &hit : collector.mHits)
+                AddBatchShapeHit(ioHits, hit, base_offset);
+        } else {
+            ClosestHitCollisionCollector<CollideShapeCollector> collector;
+            inQuery.CollideShape(shape, scale, center_of_mass_transform, settings, base_offset, collector, filters.mBroadPhaseLayerFilter, filters.mObjectLayerFilter, filters.mBodyFilter, filters.mShapeFilter);
+            if (collector.HadHit())
+                AddBatchShapeHit(ioHits, collector.mHit, base_offset);
+        }
+    });
+}
 
 void BindNarrowPhaseQuery(nb::module_ &m) {
     nb::class_<NarrowPhaseQuery, NonCopyable> narrowPhaseQueryCls(m, "NarrowPhaseQuery",
@@ -11,18 +332,18 @@ void BindNarrowPhaseQuery(nb::module_ &m) {
     narrowPhaseQueryCls
         .def("init", &NarrowPhaseQuery::Init, "body_lock_interface"_a, "broad_phase_query"_a,
             "Initialize the interface (should only be called by PhysicsSystem)")
-        .def("cast_ray", nb::overload_cast<const RRayCast &, RayCastResult &, const BroadPhaseLayerFilter &, const ObjectLayerFilter &, const BodyFilter &>(&NarrowPhaseQuery::CastRay, nb::const_), "ray"_a, "hit"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, "body_filter"_a,
+        .def("cast_ray", nb::overload_cast<const RRayCast &, RayCastResult &, const BroadPhaseLayerFilter &, const ObjectLayerFilter &, const BodyFilter &>(&NarrowPhaseQuery::CastRay, nb::const_), "ray"_a, "hit"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, "body_filter"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Cast a ray and find the closest hit. Returns true if it finds a hit. Hits further than ioHit.mFraction will not be considered and in this case ioHit will remain unmodified (and the function will return false).\n"
             "Convex objects will be treated as solid (meaning if the ray starts inside, you'll get a hit fraction of 0) and back face hits against triangles are returned.\n"
             "If you want the surface normal of the hit use Body::GetWorldSpaceSurfaceNormal(ioHit.mSubShapeID2, inRay.GetPointOnRay(ioHit.mFraction)) on body with ID ioHit.mBodyID.")
-        .def("cast_ray", nb::overload_cast<const RRayCast &, const RayCastSettings &, CastRayCollector &, const BroadPhaseLayerFilter &, const ObjectLayerFilter &, const BodyFilter &, const ShapeFilter &>(&NarrowPhaseQuery::CastRay, nb::const_), "ray"_a, "ray_cast_settings"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, "body_filter"_a, "shape_filter"_a,
+        .def("cast_ray", nb::overload_cast<const RRayCast &, const RayCastSettings &, CastRayCollector &, const BroadPhaseLayerFilter &, const ObjectLayerFilter &, const BodyFilter &, const ShapeFilter &>(&NarrowPhaseQuery::CastRay, nb::const_), "ray"_a, "ray_cast_settings"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, "body_filter"_a, "shape_filter"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Cast a ray, allows collecting multiple hits. Note that this version is more flexible but also slightly slower than the CastRay function that returns only a single hit.\n"
             "If you want the surface normal of the hit use Body::GetWorldSpaceSurfaceNormal(collected sub shape ID, inRay.GetPointOnRay(collected fraction)) on body with collected body ID.")
-        .def("collide_point", &NarrowPhaseQuery::CollidePoint, "point"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, "body_filter"_a, "shape_filter"_a,
+        .def("collide_point", &NarrowPhaseQuery::CollidePoint, "point"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, "body_filter"_a, "shape_filter"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Check if inPoint is inside any shapes. For this tests all shapes are treated as if they were solid.\n"
             "For a mesh shape, this test will only provide sensible information if the mesh is a closed manifold.\n"
             "For each shape that collides, ioCollector will receive a hit")
-        .def("collide_shape", &NarrowPhaseQuery::CollideShape, "shape"_a, "shape_scale"_a, "center_of_mass_transform"_a, "collide_shape_settings"_a, "base_offset"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, "body_filter"_a, "shape_filter"_a,
+        .def("collide_shape", &NarrowPhaseQuery::CollideShape, "shape"_a, "shape_scale"_a, "center_of_mass_transform"_a, "collide_shape_settings"_a, "base_offset"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, "body_filter"_a, "shape_filter"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Collide a shape with the system.\n"
             "Args:\n"
             "    shape (Shape*): Shape to test.\n"
@@ -35,7 +356,7 @@ void BindNarrowPhaseQuery(nb::module_ &m) {
             "    object_layer_filter (ObjectLayerFilter): Filter that filters at layer level.\n"
             "    body_filter (BodyFilter): Filter that filters at body level.\n"
             "    shape_filter (ShapeFilter): Filter that filters at shape level.")
-        .def("cast_shape", &NarrowPhaseQuery::CastShape, "shape_cast"_a, "shape_cast_settings"_a, "base_offset"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, "body_filter"_a, "shape_filter"_a,
+        .def("cast_shape", &NarrowPhaseQuery::CastShape, "shape_cast"_a, "shape_cast_settings"_a, "base_offset"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, "body_filter"_a, "shape_filter"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Cast a shape and report any hits to ioCollector.\n"
             "Args:\n"
             "    shape_cast (RShapeCast): The shape cast and its position and direction.\n"
@@ -46,6 +367,61 @@ void BindNarrowPhaseQuery(nb::module_ &m) {
             "    object_layer_filter (ObjectLayerFilter): Filter that filters at layer level.\n"
             "    body_filter (BodyFilter): Filter that filters at body level.\n"
             "    shape_filter (ShapeFilter): Filter that filters at shape level.")
-        .def("collect_transformed_shapes", &NarrowPhaseQuery::CollectTransformedShapes, "box"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, "body_filter"_a, "shape_filter"_a,
-            "Collect all leaf transformed shapes that fall inside world space box inBox");
+        .def("collect_transformed_shapes", &NarrowPhaseQuery::CollectTransformedShapes, "box"_a, "collector"_a, "broad_phase_layer_filter"_a, "object_layer_filter"_a, "body_filter"_a, "shape_filter"_a, nb::call_guard<nb::gil_scoped_release>(),
+            "Collect all leaf transformed shapes that fall inside world space box inBox")
+        .def("cast_rays", &CastRays, "origins"_a, "directions"_a, "job_system"_a.none() = nb::none(), "any_hit"_a = false, "calculate_normals"_a = false, "sort_rays"_a = true,
+            "ray_cast_settings"_a.none() = nb::none(), "broad_phase_layer_filter"_a.none() = nb::none(), "object_layer_filter"_a.none() = nb::none(), "body_filter"_a.none() = nb::none(), "shape_filter"_a.none() = nb::none(),
+            "Cast a batch of rays, the rays are distributed over the job system and the GIL is released while casting.\n"
+            "Filters implemented in Python are supported but will serialize the casts on the GIL.\n"
+            "Args:\n"
+            "    origins (ndarray): (N, 3) float32 or float64 array with the start points of the rays.\n"
+            "    directions (ndarray): (N, 3) float32 or float64 array with the directions of the rays, the length of the direction is the length of the ray.\n"
+            "    job_system (JobSystem): Job system to cast the rays on, when None the rays are cast on the calling thread.\n"
+            "    any_hit (bool): Stop at the first hit found instead of searching for the closest hit, useful for line of sight checks.\n"
+            "    calculate_normals (bool): Also return the world space surface normal at the hit.\n"
+            "    sort_rays (bool): Cast the rays in spatial order of their origin, which improves cache coherence for large unordered batches.\n"
+            "    ray_cast_settings (RayCastSettings): Settings for the ray casts, when None the default settings are used (back faces of triangles are ignored).\n"
+            "    broad_phase_layer_filter (BroadPhaseLayerFilter): Filter that filters at broadphase level.\n"
+            "    object_layer_filter (ObjectLayerFilter): Filter that filters at layer level.\n"
+            "    body_filter (BodyFilter): Filter that filters at body level.\n"
+            "    shape_filter (ShapeFilter): Filter that filters at shape level.\n"
+            "Returns:\n"
+            "    dict: 'hit' (N,) bool, 'fraction' (N,) float32 (FLT_MAX for a miss), 'body_id' (N,) uint32, 'sub_shape_id' (N,) uint32 and if requested 'normal' (N, 3) float32, in the order of the input rays.")
+        .def("cast_shapes", &CastShapes, "shapes"_a, "positions"_a, "directions"_a, "rotations"_a.none() = nb::none(), "scales"_a.none() = nb::none(), "job_system"_a.none() = nb::none(), "all_hits"_a = false,
+            "shape_cast_settings"_a.none() = nb::none(), "broad_phase_layer_filter"_a.none() = nb::none(), "object_layer_filter"_a.none() = nb::none(), "body_filter"_a.none() = nb::none(), "shape_filter"_a.none() = nb::none(),
+            "Cast a batch of shapes, the casts are distributed over the job system and the GIL is released while casting.\n"
+            "Args:\n"
+            "    shapes (Shape | list[Shape]): Shape to cast for every query, or a sequence with one shape per query.\n"
+            "    positions (ndarray): (N, 3) float32 or float64 array with the start positions of the shapes (like Body position, not the center of mass).\n"
+            "    directions (ndarray): (N, 3) float32 or float64 array with the displacement of the casts.\n"
+            "    rotations (ndarray): Optional (N, 4) float32 or float64 array with the start rotations (x, y, z, w).\n"
+            "    scales (ndarray): Optional (N, 3) float32 or float64 array with the scales of the shapes.\n"
+            "    job_system (JobSystem): Job system to run the casts on, when None the casts run on the calling thread.\n"
+            "    all_hits (bool): Return all hits sorted by fraction instead of only the closest hit.\n"
+            "    shape_cast_settings (ShapeCastSettings): Settings for the casts, when None the default settings are used.\n"
+            "    broad_phase_layer_filter (BroadPhaseLayerFilter): Filter that filters at broadphase level.\n"
+            "    object_layer_filter (ObjectLayerFilter): Filter that filters at layer level.\n"
+            "    body_filter (BodyFilter): Filter that filters at body level.\n"
+            "    shape_filter (ShapeFilter): Filter that filters at shape level.\n"
+            "Returns:\n"
+            "    dict: Hits in CSR layout, the hits of query i are at offsets[i]:offsets[i + 1]. 'offsets' (N + 1,) uint32, and per hit 'body_id', 'sub_shape_id1', 'sub_shape_id2' uint32,\n"
+            "    'contact_point_on1', 'contact_point_on2' (H, 3) in world space, 'penetration_axis' (H, 3) float32, 'penetration_depth', 'fraction' float32 and 'is_back_face_hit' bool.")
+        .def("collide_shapes", &CollideShapes, "shapes"_a, "positions"_a, "rotations"_a.none() = nb::none(), "scales"_a.none() = nb::none(), "job_system"_a.none() = nb::none(), "all_hits"_a = false,
+            "collide_shape_settings"_a.none() = nb::none(), "broad_phase_layer_filter"_a.none() = nb::none(), "object_layer_filter"_a.none() = nb::none(), "body_filter"_a.none() = nb::none(), "shape_filter"_a.none() = nb::none(),
+            "Collide a batch of shapes with the system, the queries are distributed over the job system and the GIL is released while colliding.\n"
+            "Args:\n"
+            "    shapes (Shape | list[Shape]): Shape to test for every query, or a sequence with one shape per query.\n"
+            "    positions (ndarray): (N, 3) float32 or float64 array with the positions of the shapes (like Body position, not the center of mass).\n"
+            "    rotations (ndarray): Optional (N, 4) float32 or float64 array with the rotations (x, y, z, w).\n"
+            "    scales (ndarray): Optional (N, 3) float32 or float64 array with the scales of the shapes.\n"
+            "    job_system (JobSystem): Job system to run the queries on, when None the queries run on the calling thread.\n"
+            "    all_hits (bool): Return all hits sorted by penetration depth (deepest first) instead of only the deepest hit.\n"
+            "    collide_shape_settings (CollideShapeSettings): Settings for the queries, when None the default settings are used.\n"
+            "    broad_phase_layer_filter (BroadPhaseLayerFilter): Filter that filters at broadphase level.\n"
+            "    object_layer_filter (ObjectLayerFilter): Filter that filters at layer level.\n"
+            "    body_filter (BodyFilter): Filter that filters at body level.\n"
+            "    shape_filter (ShapeFilter): Filter that filters at shape level.\n"
+            "Returns:\n"
+            "    dict: Hits in CSR layout, the hits of query i are at offsets[i]:offsets[i + 1]. 'offsets' (N + 1,) uint32, and per hit 'body_id', 'sub_shape_id1', 'sub_shape_id2' uint32,\n"
+            "    'contact_point_on1', 'contact_point_on2' (H, 3) in world space, 'penetration_axis' (H, 3) float32 and 'penetration_depth' float32.");
 }
\ No newline at end of file
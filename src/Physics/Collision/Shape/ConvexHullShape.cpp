@@ -3,6 +3,7 @@
 #include <Jolt/Physics/Collision/CollideSoftBodyVertexIterator.h>
 #include <Jolt/Physics/Collision/RayCast.h>
 #include <Jolt/Physics/Collision/CastResult.h>
+#include "BindingUtility/ShapeSettingsLock.h"
 
 void BindConvexHullShape(nb::module_ &m) {
     nb::class_<ConvexHullShapeSettings, ConvexShapeSettings> convexHullShapeSettingsCls(m, "ConvexHullShapeSettings",
@@ -15,7 +16,9 @@ void BindConvexHullShape(nb::module_ &m) {
             "Create a convex hull from inPoints and maximum convex radius inMaxConvexRadius, the radius is automatically lowered if the hull requires it.\n"
             "(internally this will be subtracted so the total size will not grow with the convex radius).")
         .def(nb::init<const Array<Vec3> &, float, const PhysicsMaterial *>(), "points"_a, "convex_radius"_a = cDefaultConvexRadius, "material"_a = nullptr)
-        .def("create", &ConvexHullShapeSettings::Create)
+        .def("create", &ShapeSettingsLock::sCreate, nb::call_guard<nb::gil_scoped_release>(),
+            "Runs without the GIL, calls for the same settings from several threads are serialized. Child settings that are shared with settings that\n"
+            "are created on another thread at the same time are not protected, their cached result is written without synchronization.")
         .def_rw("points", &ConvexHullShapeSettings::mPoints,
             "Points to create the hull from")
         .def_rw("max_convex_radius", &ConvexHullShapeSettings::mMaxConvexRadius,
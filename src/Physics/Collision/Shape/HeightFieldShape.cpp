@@ -6,6 +6,7 @@
 #include <Jolt/Physics/Collision/CastResult.h>
 #include <Jolt/Physics/Collision/TransformedShape.h>
 #include <Jolt/Core/TempAllocator.h>
+#include "BindingUtility/ShapeSettingsLock.h"
 
 void BindHeightFieldShape(nb::module_ &m) {
     using namespace HeightFieldShapeConstants;
@@ -40,7 +41,9 @@ void BindHeightFieldShape(nb::module_ &m) {
             "inSampleCount: inSampleCount / mBlockSize must be minimally 2 and a power of 2 is the most efficient in terms of performance and storage.\n"
             "inSamples: inSampleCount^2 vertices.\n"
             "inMaterialIndices: (inSampleCount - 1)^2 indices that index into inMaterialList.")
-        .def("create", &HeightFieldShapeSettings::Create)
+        .def("create", &ShapeSettingsLock::sCreate, nb::call_guard<nb::gil_scoped_release>(),
+            "Runs without the GIL, calls for the same settings from several threads are serialized. Child settings that are shared with settings that\n"
+            "are created on another thread at the same time are not protected, their cached result is written without synchronization.")
         .def("determine_min_and_max_sample", &HeightFieldShapeSettings::DetermineMinAndMaxSample, "min_value"_a, "max_value"_a, "quantization_scale"_a,
             "Determine the minimal and maximal value of mHeightSamples (will ignore cNoCollisionValue).\n"
             "Args:\n"
@@ -3,6 +3,37 @@
 #include <Jolt/Physics/Collision/RayCast.h>
 #include <Jolt/Physics/Collision/CastResult.h>
 #include <Jolt/Physics/Collision/CollideSoftBodyVertexIterator.h>
+#include "BindingUtility/MeshCooking.h"
+#include "BindingUtility/ShapeSettingsLock.h"
+#include <nanobind/stl/optional.h>
+
+static Ref<MeshShapeSettings> MeshShapeSettingsFromArrays(const NumpyRows<3> &inVertices, const NumpyTriangles &inTriangles, std::optional<NumpyTriangleValues> inMaterialIndices,
+                                                          std::optional<NumpyTriangleValues> inUserData, const PhysicsMaterialList &inMaterials, bool inSanitize, JobSystem *inJobSystem) {
+    size_t num_vertices = inVertices.shape(0);
+    size_t num_triangles = inTriangles.shape(0);
+    if (num_vertices > size_t(std::numeric_limits<uint32>::max()))
+        throw nb::value_error("vertices: too many vertices");
+    if (inMaterialIndices && inMaterialIndices->shape(0) != num_triangles)
+        throw nb::value_error("material_indices: expected one value per triangle");
+    if (inUserData && inUserData->shape(0) != num_triangles)
+        throw nb::value_error("user_data: expected one value per triangle");
+    NumpyRowReader<3> vertices(inVertices, num_vertices, "vertices");
+
+    Ref<MeshShapeSettings> settings = new MeshShapeSettings;
+    settings->mMaterials = inMaterials;
+    settings->mPerTriangleUserData = inUserData.has_value();
+    bool valid;
+    {
+        nb::gil_scoped_release release;
+        valid = FillMeshShapeSettings(*settings, vertices, num_vertices, inTriangles.data(), num_triangles,
+            inMaterialIndices ? inMaterialIndices->data() : nullptr, inUserData ? inUserData->data() : nullptr, inJobSystem);
+        if (valid && inSanitize)
+            SanitizeMeshParallel(*settings, inJobSystem);
+    }
+    if (!valid)
+        throw nb::value_error("triangles: vertex index out of range");
+    return settings;
+}
 
 void BindMeshShape(nb::module_ &m) {
     nb::class_<MeshShapeSettings, ShapeSettings> meshShapeSettingsCls(m, "MeshShapeSettings",
@@ -16,7 +47,38 @@ void BindMeshShape(nb::module_ &m) {
         .def(nb::init<VertexList, IndexedTriangleList, PhysicsMaterialList>(), "vertices"_a, "triangles"_a, "materials"_a = PhysicsMaterialList ())
         .def("sanitize", &MeshShapeSettings::Sanitize,
             "Sanitize the mesh data. Remove duplicate and degenerate triangles. This is called automatically when constructing the MeshShapeSettings with a list of (indexed-) triangles.")
-        .def("create", &MeshShapeSettings::Create)
+        .def("sanitize", &SanitizeMeshParallel, "job_system"_a.none(), nb::call_guard<nb::gil_scoped_release>(),
+            "Same as sanitize() but the triangles are checked in parallel on the job system, and the remaining triangles keep their order.")
+        .def_static("from_arrays", &MeshShapeSettingsFromArrays, "vertices"_a, "triangles"_a, "material_indices"_a.none() = nb::none(), "user_data"_a.none() = nb::none(),
+            "materials"_a = PhysicsMaterialList(), "sanitize"_a = true, "job_system"_a.none() = nb::none(),
+            "Create mesh shape settings from arrays without creating a Python object per vertex or triangle.\n"
+            "Args:\n"
+            "    vertices (ndarray): (V, 3) float32 or float64 array with the vertices.\n"
+            "    triangles (ndarray): (T, 3) uint32 array with the vertex indices of the triangles, in counter clockwise order.\n"
+            "    material_indices (ndarray, optional): (T,) uint32 array with the index in materials of every triangle.\n"
+            "    user_data (ndarray, optional): (T,) uint32 array with the user data of every triangle, enables per_triangle_user_data.\n"
+            "    materials (list[PhysicsMaterial]): Materials of the triangles.\n"
+            "    sanitize (bool): Remove degenerate and duplicate triangles.\n"
+            "    job_system (JobSystem, optional): Job system to convert and sanitize the data on, when None this happens on the calling thread.\n"
+            "Returns:\n"
+            "    MeshShapeSettings: The settings.")
+        .def("create", &ShapeSettingsLock::sCreate, nb::call_guard<nb::gil_scoped_release>(),
+            "Runs without the GIL, calls for the same settings from several threads are serialized. Child settings that are shared with settings that\n"
+            "are created on another thread at the same time are not protected, their cached result is written without synchronization.")
+        .def("create_parallel", [](const MeshShapeSettings &self, JobSystem *job_system, size_t max_triangles_per_chunk) {
+            if (max_triangles_per_chunk == 0)
+                throw nb::value_error("max_triangles_per_chunk must be larger than 0");
+            nb::gil_scoped_release release;
+            return CreateMeshShapeParallel(self, job_system, max_triangles_per_chunk);
+        }, "job_system"_a, "max_triangles_per_chunk"_a = 65536,
+            "Create the shape of a large mesh on the job system. The triangles are split spatially into chunks that find their active edges and build\n"
+            "their tree in parallel, the chunks are combined in a StaticCompoundShape. Edges on the border between two chunks are always active,\n"
+            "the sub shape IDs differ from a single MeshShape and the result is not cached in the settings. Meshes that fit in one chunk return create().\n"
+            "Args:\n"
+            "    job_system (JobSystem): Job system to cook the chunks on.\n"
+            "    max_triangles_per_chunk (int): Maximum number of triangles per chunk.\n"
+            "Returns:\n"
+            "    ShapeResult: The shape or the error of cooking a chunk.")
         .def_rw("triangle_vertices", &MeshShapeSettings::mTriangleVertices,
             "Vertices belonging to mIndexedTriangles")
         .def_rw("indexed_triangles", &MeshShapeSettings::mIndexedTriangles,
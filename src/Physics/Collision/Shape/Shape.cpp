@@ -7,6 +7,7 @@
 #include <Jolt/Renderer/DebugRenderer.h>
 #include <Jolt/Physics/Collision/CollideSoftBodyVertexIterator.h>
 
+#include "BindingUtility/ShapeSettingsLock.h"
 #include <nanobind/stl/vector.h>
 
 void BindShape(nb::module_ &m) {
@@ -117,8 +118,10 @@ void BindShape(nb::module_ &m) {
             "and can be destroyed. Each shape class has a derived class of the ShapeSettings object to store shape specific\n"
             "data.");
     shapeSettingsCls
-        .def("create", &ShapeSettings::Create,
-            "Create a shape according to the settings specified by this object.") // TODO:
+        .def("create", &ShapeSettingsLock::sCreate, nb::call_guard<nb::gil_scoped_release>(),
+            "Create a shape according to the settings specified by this object.\n"
+            "Runs without the GIL, calls for the same settings from several threads are serialized. Child settings that are shared with settings that\n"
+            "are created on another thread at the same time are not protected, their cached result is written without synchronization.")
         .def("clear_cached_result", &ShapeSettings::ClearCachedResult,
             "When creating a shape, the result is cached so that calling Create() again will return the same shape.\n"
             "If you make changes to the ShapeSettings you need to call this function to clear the cached result to allow Create() to build a new shape.")
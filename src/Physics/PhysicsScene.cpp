@@ -1,7 +1,7 @@
 #include "Common.h"
 #include <Jolt/Physics/PhysicsScene.h>
 #include <Jolt/Physics/PhysicsSystem.h>
-#include "BindingUtility/Stream.h"
+#include "BindingUtility/NativeStreams.h"
 
 void BindPhysicsScene(nb::module_ &m) {
     nb::class_<PhysicsScene, RefTarget<PhysicsScene>> physicsSceneCls(m,"PhysicsScene",
@@ -32,27 +32,33 @@ void BindPhysicsScene(nb::module_ &m) {
             "Get number of bodies in this scene")
         .def("get_soft_bodies", nb::overload_cast<>(&PhysicsScene::GetSoftBodies),
             "Access to the soft body settings for this scene")
-        .def("create_bodies", &PhysicsScene::CreateBodies, "system"_a,
+        .def("create_bodies", &PhysicsScene::CreateBodies, "system"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Instantiate all bodies, returns false if not all bodies could be created")
         .def("fix_invalid_scales", &PhysicsScene::FixInvalidScales,
             "Go through all body creation settings and fix shapes that are scaled incorrectly (note this will change the scene a bit).\n"
             "Returns:\n"
             "    bool: False when not all scales could be fixed.")
         .def("save_binary_state", [](const PhysicsScene &self, nb::object py_stream, bool inSaveShapes, bool inSaveGroupFilter){
-            PythonStreamOut stream_adapter(py_stream);
-            self.SaveBinaryState(stream_adapter, inSaveShapes, inSaveGroupFilter);
-            if (stream_adapter.IsFailed())
-                throw std::runtime_error("Failed to save binary state due to a Python I/O error.");
+            StreamOutArg stream(py_stream);
+            bool ok;
+            {
+                nb::gil_scoped_release release;
+                self.SaveBinaryState(stream.Get(), inSaveShapes, inSaveGroupFilter);
+                ok = stream.Flush();
+            }
+            if (!ok)
+                throw std::runtime_error("Failed to save binary state, the stream failed.");
             }, "stream"_a, "save_shapes"_a, "save_group_filter"_a,
             "Saves the state of this object in binary form to inStream.\n"
             "Args:\n"
-            "    stream (StreamOut): The stream to save the state to.\n"
+            "    stream (StreamOut | file-like): The stream to save the state to, Python objects are wrapped in a PythonStreamOut.\n"
             "    save_shapes (bool): If the shapes should be saved as well (these could be shared between physics scenes, in which case the calling application may want to write custom code to restore them).\n"
             "    save_group_filter (bool): If the group filter should be saved as well (these could be shared).")
         .def_static("restore_from_binary_state", [](nb::object py_stream) {
-            PythonStreamIn stream_adapter(py_stream);
-            return PhysicsScene::sRestoreFromBinaryState(stream_adapter);
-        }, "stream"_a, "Restore a saved scene from inStream")
+            StreamInArg stream(py_stream);
+            nb::gil_scoped_release release;
+            return PhysicsScene::sRestoreFromBinaryState(stream.Get());
+        }, "stream"_a, "Restore a saved scene from inStream, a StreamIn or a Python object that is wrapped in a PythonStreamIn")
         .def("from_physics_system", &PhysicsScene::FromPhysicsSystem, "system"_a,
             "For debugging purposes: Construct a scene from the current state of the physics system")
         .def_ro_static("C_FIXED_TO_WORLD", &PhysicsScene::cFixedToWorld,
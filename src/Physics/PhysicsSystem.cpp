@@ -6,7 +6,255 @@
 #include <Jolt/Physics/SoftBody/SoftBodyContactListener.h>
 #include <Jolt/Physics/PhysicsStepListener.h>
 #include <Jolt/Renderer/DebugRenderer.h>
+#include <Jolt/Physics/Body/BodyLockMulti.h>
+#include <Jolt/Physics/Collision/BroadPhase/BroadPhase.h>
+#include <Jolt/Core/QuickSort.h>
 #include <nanobind/stl/vector.h>
+#include "BindingUtility/NumpyRows.h"
+#include "BindingUtility/FrozenLayerFilters.h"
+#include "BindingUtility/AsyncUpdate.h"
+#include "BindingUtility/StateRecorderBuffer.h"
+#include <nanobind/stl/optional.h>
+
+// PhysicsSystem::Init that optionally replaces the layer interface and filters by a frozen copy, the copy is owned by the Python PhysicsSystem object
+static void InitPhysicsSystem(PhysicsSystem &inSystem, uint inMaxBodies, uint inNumBodyMutexes, uint inMaxBodyPairs, uint inMaxContactConstraints,
+                              const BroadPhaseLayerInterface &inBroadPhaseLayerInterface, const ObjectVsBroadPhaseLayerFilter &inObjectVsBroadPhaseLayerFilter, const ObjectLayerPairFilter &inObjectLayerPairFilter,
+                              std::optional<uint> inNumObjectLayers, bool inFreezeLayerFilters) {
+    if (inFreezeLayerFilters && !FrozenLayerFilters::sIsNative(inBroadPhaseLayerInterface, inObjectVsBroadPhaseLayerFilter, inObjectLayerPairFilter)) {
+        uint num_object_layers = inNumObjectLayers ? *inNumObjectLayers : FrozenLayerFilters::sProbeNumObjectLayers(inBroadPhaseLayerInterface);
+        FrozenLayerFilters *frozen = nullptr;
+        if (num_object_layers > 0) {
+            try {
+                frozen = new FrozenLayerFilters(num_object_layers, inBroadPhaseLayerInterface, inObjectVsBroadPhaseLayerFilter, inObjectLayerPairFilter);
+            } catch (nb::python_error &e) {
+                nb::module_::import_("warnings").attr("warn")(std::string("PhysicsSystem.init: layer filters could not be frozen and stay in Python: ") + e.what());
+            }
+        } else {
+            nb::module_::import_("warnings").attr("warn")("PhysicsSystem.init: could not count the object layers, pass num_object_layers to freeze the layer filters");
+        }
+
+        if (frozen != nullptr) {
+            if (frozen->mNumFailedPairs > 0)
+                nb::module_::import_("warnings").attr("warn")("PhysicsSystem.init: " + std::to_string(frozen->mNumFailedPairs) + " layer pair tests raised and are frozen as not colliding, first error: " + frozen->mFirstError);
+            nb::capsule owner(frozen, [](void *p) noexcept { delete static_cast<FrozenLayerFilters *>(p); });
+            nb::detail::keep_alive(nb::find(&inSystem).ptr(), owner.ptr());
+            inSystem.Init(inMaxBodies, inNumBodyMutexes, inMaxBodyPairs, inMaxContactConstraints, frozen->mBroadPhaseLayerInterface, frozen->mObjectVsBroadPhaseLayerFilter, frozen->mObjectLayerPairFilter);
+            return;
+        }
+    }
+
+    inSystem.Init(inMaxBodies, inNumBodyMutexes, inMaxBodyPairs, inMaxContactConstraints, inBroadPhaseLayerInterface, inObjectVsBroadPhaseLayerFilter, inObjectLayerPairFilter);
+}
+
+// Fills the requested channels for all bodies in inIDs under a single lock of the involved body mutexes
+static size_t ReadBodyStates(const PhysicsSystem &inSystem, const NumpyBodyIDs &inIDs,
+                             const NumpyRows<3> &outPositions, const NumpyRows<4> &outRotations,
+                             const NumpyRows<3> &outLinearVelocities, const NumpyRows<3> &outAngularVelocities) {
+    size_t count = inIDs.shape(0);
+    NumpyRowWriter<3> positions(outPositions, count, "out_positions");
+    NumpyRowWriter<4> rotations(outRotations, count, "out_rotations");
+    NumpyRowWriter<3> linear_velocities(outLinearVelocities, count, "out_linear_velocities");
+    NumpyRowWriter<3> angular_velocities(outAngularVelocities, count, "out_angular_velocities");
+
+    size_t num_found = 0;
+    if (count == 0)
+        return num_found;
+
+    nb::gil_scoped_release release;
+
+    BodyLockMultiRead lock(inSystem.GetBodyLockInterface(), ToBodyIDs(inIDs), (int)count);
+    for (size_t i = 0; i < count; ++i) {
+        const Body *body = lock.GetBody((int)i);
+        if (body == nullptr) {
+            if (positions.IsEnabled())
+                positions.StoreNaN(i);
+            if (rotations.IsEnabled())
+                rotations.StoreNaN(i);
+            if (linear_velocities.IsEnabled())
+                linear_velocities.StoreNaN(i);
+            if (angular_velocities.IsEnabled())
+                angular_velocities.StoreNaN(i);
+            continue;
+        }
+
+        ++num_found;
+        if (positions.IsEnabled())
+            positions.Store(i, body->GetPosition());
+        if (rotations.IsEnabled())
+            rotations.Store(i, body->GetRotation());
+        if (linear_velocities.IsEnabled())
+            linear_velocities.Store(i, body->GetLinearVelocity());
+        if (angular_velocities.IsEnabled())
+            angular_velocities.Store(i, body->GetAngularVelocity());
+    }
+
+    return num_found;
+}
+
+// Bodies that need activation are collected while the body locks are held and activated afterwards,
+// BodyInterface::ActivateBodies takes the body locks itself. Bodies that are not in the broadphase can't be activated.
+class BatchedActivation {
+  public:
+    inline void Activate(Body &ioBody, EActivation inActivationMode) {
+        if (inActivationMode != EActivation::Activate || !ioBody.IsInBroadPhase())
+            return;
+        if (ioBody.IsActive())
+            ioBody.ResetSleepTimer();
+        else
+            mBodyIDs.push_back(ioBody.GetID());
+    }
+
+    inline void ActivateIfMoving(const Body &inBody, Vec3Arg inLinearVelocity, Vec3Arg inAngularVelocity) {
+        if (!inBody.IsActive() && inBody.IsInBroadPhase() && (!inLinearVelocity.IsNearZero() || !inAngularVelocity.IsNearZero()))
+            mBodyIDs.push_back(inBody.GetID());
+    }
+
+    void Flush(PhysicsSystem &ioSystem) {
+        if (mBodyIDs.empty())
+            return;
+        QuickSort(mBodyIDs.begin(), mBodyIDs.end());
+        mBodyIDs.erase(std::unique(mBodyIDs.begin(), mBodyIDs.end()), mBodyIDs.end());
+
+        // Another thread can remove or destroy a body between the release of the body locks and now
+        {
+            BodyLockMultiRead lock(ioSystem.GetBodyLockInterface(), mBodyIDs.data(), (int)mBodyIDs.size());
+            size_t num_kept = 0;
+            for (size_t i = 0; i < mBodyIDs.size(); ++i) {
+                const Body *body = lock.GetBody((int)i);
+                if (body != nullptr && body->IsInBroadPhase())
+                    mBodyIDs[num_kept++] = mBodyIDs[i];
+            }
+            mBodyIDs.resize(num_kept);
+        }
+        if (!mBodyIDs.empty())
+            ioSystem.GetBodyInterface().ActivateBodies(mBodyIDs.data(), (int)mBodyIDs.size());
+    }
+
+  private:
+    Array<BodyID> mBodyIDs;
+};
+
+// The broadphase is only exposed through its query interface. PhysicsSystem::Init puts a BroadPhase behind it, this is checked
+// instead of assumed: nullptr means the batched update is not possible and the bodies have to go through the BodyInterface.
+static inline BroadPhase *GetBroadPhase(PhysicsSystem &inSystem) {
+    return dynamic_cast<BroadPhase *>(const_cast<BroadPhaseQuery *>(&inSystem.GetBroadPhaseQuery()));
+}
+
+// Applies the given channels to all bodies in inIDs under a single lock, followed by one broadphase update and one activation batch
+static size_t WriteBodyStates(PhysicsSystem &ioSystem, const NumpyBodyIDs &inIDs,
+                              const NumpyRows<3> &inPositions, const NumpyRows<4> &inRotations,
+                              const NumpyRows<3> &inLinearVelocities, const NumpyRows<3> &inAngularVelocities,
+                              EActivation inActivationMode) {
+    size_t count = inIDs.shape(0);
+    NumpyRowReader<3> positions(inPositions, count, "positions");
+    NumpyRowReader<4> rotations(inRotations, count, "rotations");
+    NumpyRowReader<3> linear_velocities(inLinearVelocities, count, "linear_velocities");
+    NumpyRowReader<3> angular_velocities(inAngularVelocities, count, "angular_velocities");
+
+    size_t num_found = 0;
+    if (count == 0)
+        return num_found;
+
+    nb::gil_scoped_release release;
+
+    bool set_transform = positions.IsEnabled() || rotations.IsEnabled();
+    bool set_velocity = linear_velocities.IsEnabled() || angular_velocities.IsEnabled();
+    Array<BodyID> moved;
+    if (set_transform)
+        moved.reserve(count);
+    BroadPhase *broad_phase = GetBroadPhase(ioSystem);
+    BatchedActivation activation;
+    {
+        BodyLockMultiWrite lock(ioSystem.GetBodyLockInterface(), ToBodyIDs(inIDs), (int)count);
+        for (size_t i = 0; i < count; ++i) {
+            Body *body = lock.GetBody((int)i);
+            if (body == nullptr)
+                continue;
+            ++num_found;
+
+            if (set_transform) {
+                RVec3 position = positions.IsEnabled() ? positions.LoadRVec3(i) : body->GetPosition();
+                Quat rotation = rotations.IsEnabled() ? rotations.LoadQuat(i) : body->GetRotation();
+                body->SetPositionAndRotationInternal(position, rotation);
+                if (body->IsInBroadPhase())
+                    moved.push_back(body->GetID());
+                activation.Activate(*body, inActivationMode);
+            }
+
+            if (set_velocity && !body->IsStatic()) {
+                Vec3 linear_velocity = linear_velocities.IsEnabled() ? linear_velocities.LoadVec3(i) : body->GetLinearVelocity();
+                Vec3 angular_velocity = angular_velocities.IsEnabled() ? angular_velocities.LoadVec3(i) : body->GetAngularVelocity();
+                body->SetLinearVelocityClamped(linear_velocity);
+                body->SetAngularVelocityClamped(angular_velocity);
+                activation.ActivateIfMoving(*body, linear_velocity, angular_velocity);
+            }
+        }
+
+        if (!moved.empty() && broad_phase != nullptr) {
+            broad_phase->NotifyBodiesAABBChanged(moved.data(), (int)moved.size());
+            moved.clear();
+        }
+    }
+
+    // Setting the transform again through the BodyInterface updates the broadphase one body at a time
+    BodyInterface &body_interface = ioSystem.GetBodyInterface();
+    for (const BodyID &id : moved) {
+        RVec3 position;
+        Quat rotation;
+        body_interface.GetPositionAndRotation(id, position, rotation);
+        body_interface.SetPositionAndRotation(id, position, rotation, EActivation::DontActivate);
+    }
+    activation.Flush(ioSystem);
+
+    return num_found;
+}
+
+// Adds forces / torques (inImpulse = false) or linear / angular impulses (inImpulse = true) to all dynamic bodies in inIDs
+static size_t AddBodyForces(PhysicsSystem &ioSystem, const NumpyBodyIDs &inIDs,
+                            const NumpyRows<3> &inLinear, const NumpyRows<3> &inAngular,
+                            EActivation inActivationMode, bool inImpulse) {
+    size_t count = inIDs.shape(0);
+    NumpyRowReader<3> linear(inLinear, count, inImpulse ? "impulses" : "forces");
+    NumpyRowReader<3> angular(inAngular, count, inImpulse ? "angular_impulses" : "torques");
+
+    size_t num_applied = 0;
+    if (count == 0)
+        return num_applied;
+
+    nb::gil_scoped_release release;
+
+    BatchedActivation activation;
+    {
+        BodyLockMultiWrite lock(ioSystem.GetBodyLockInterface(), ToBodyIDs(inIDs), (int)count);
+        for (size_t i = 0; i < count; ++i) {
+            Body *body = lock.GetBody((int)i);
+            if (body == nullptr || !body->IsDynamic())
+                continue;
+
+            if (inImpulse) {
+                // Same as BodyInterface::AddImpulse, impulses always wake up the body
+                if (linear.IsEnabled())
+                    body->AddImpulse(linear.LoadVec3(i));
+                if (angular.IsEnabled())
+                    body->AddAngularImpulse(angular.LoadVec3(i));
+                activation.Activate(*body, EActivation::Activate);
+            } else {
+                // Same as BodyInterface::AddForce, forces on sleeping bodies are dropped unless the body is activated
+                if (inActivationMode != EActivation::Activate && !body->IsActive())
+                    continue;
+                if (linear.IsEnabled())
+                    body->AddForce(linear.LoadVec3(i));
+                if (angular.IsEnabled())
+                    body->AddTorque(angular.LoadVec3(i));
+                activation.Activate(*body, inActivationMode);
+            }
+            ++num_applied;
+        }
+    }
+    activation.Flush(ioSystem);
+
+    return num_applied;
+}
 
 void BindPhysicsSystem(nb::module_ &m) {
     nb::class_<PhysicsSystem, NonCopyable> physicsSystemCls(m, "PhysicsSystem",
@@ -15,9 +263,10 @@ void BindPhysicsSystem(nb::module_ &m) {
     physicsSystemCls
         .def(nb::init<>(),
             "Constructor / Destructor")
-        .def("init", &PhysicsSystem::Init,
+        .def("init", &InitPhysicsSystem,
             "max_bodies"_a, "num_body_mutexes"_a, "max_body_pairs"_a, "max_contact_constraints"_a,
             "broad_phase_layer_interface"_a, "object_vs_broad_phase_layer_filter"_a, "object_layer_pair_filter"_a,
+            "num_object_layers"_a.none() = nb::none(), "freeze_layer_filters"_a = true,
             "Initialize the system.\n"
             "Args:\n"
             "    max_bodies (int): Maximum number of bodies to support.\n"
@@ -26,7 +275,12 @@ void BindPhysicsSystem(nb::module_ &m) {
             "    max_contact_constraints (int): Maximum amount of contact constraints to process (anything else will fall through the world).\n"
             "    broad_phase_layer_interface (BroadPhaseLayerInterface): Information on the mapping of object layers to broad phase layers. Since this is a virtual interface, the instance needs to stay alive during the lifetime of the PhysicsSystem.\n"
             "    object_vs_broad_phase_layer_filter (ObjectVsBroadPhaseLayerFilter): Filter callback function that is used to determine if an object layer collides with a broad phase layer. Since this is a virtual interface, the instance needs to stay alive during the lifetime of the PhysicsSystem.\n"
-            "    object_layer_pair_filter (ObjectLayerPairFilter): Filter callback function that is used to determine if two object layers collide. Since this is a virtual interface, the instance needs to stay alive during the lifetime of the PhysicsSystem.")
+            "    object_layer_pair_filter (ObjectLayerPairFilter): Filter callback function that is used to determine if two object layers collide. Since this is a virtual interface, the instance needs to stay alive during the lifetime of the PhysicsSystem.\n"
+            "    num_object_layers (int): Number of object layers, used when freezing the layer filters. When None the layers are counted by calling get_broad_phase_layer until it raises (up to 256 layers).\n"
+            "    freeze_layer_filters (bool): Evaluate the layer interface and filters once for all layers and install native lookup tables with the same answers,\n"
+            "        this removes the GIL from broadphase pair finding when the filters are implemented in Python. Disable for filters whose answers change over time.\n"
+            "        Filters that are already table or mask based are used as is. A layer interface that raises is used as is with a warning, a pair test that raises is\n"
+            "        frozen as not colliding with a warning. Object layers beyond num_object_layers map to broadphase layer 0 and collide with nothing.")
         .def("set_body_activation_listener", &PhysicsSystem::SetBodyActivationListener, "listener"_a.none(),
             "Listener that is notified whenever a body is activated/deactivated")
         .def("get_body_activation_listener", &PhysicsSystem::GetBodyActivationListener, nb::rv_policy::reference)
@@ -67,7 +321,7 @@ void BindPhysicsSystem(nb::module_ &m) {
             // "Batch remove constraints.")
         .def("get_constraints", &PhysicsSystem::GetConstraints,
             "Get a list of all constraints")
-        .def("optimize_broad_phase", &PhysicsSystem::OptimizeBroadPhase,
+        .def("optimize_broad_phase", &PhysicsSystem::OptimizeBroadPhase, nb::call_guard<nb::gil_scoped_release>(),
             "Optimize the broadphase, needed only if you've added many bodies prior to calling Update() for the first time.\n"
             "Don't call this every frame as PhysicsSystem::Update spreads out the same work over multiple frames.\n"
             "If you add many bodies through BodyInterface::AddBodiesPrepare/AddBodiesFinalize and if the bodies in a batch are\n"
@@ -84,10 +338,48 @@ void BindPhysicsSystem(nb::module_ &m) {
             "The world steps for a total of inDeltaTime seconds. This is divided in inCollisionSteps iterations.\n"
             "Each iteration consists of collision detection followed by an integration step.\n"
             "This function internally spawns jobs using inJobSystem and waits for them to complete, so no jobs will be running when this function returns.")
+        .def("update_async", [](PhysicsSystem &self, float delta_time, int collision_steps, TempAllocator *temp_allocator, JobSystem *job_system, TransformSnapshot *snapshot) {
+            if (snapshot != nullptr && &snapshot->GetSystem() != &self)
+                throw nb::value_error("snapshot belongs to a different PhysicsSystem");
+            nb::gil_scoped_release release;
+            if (snapshot != nullptr)
+                snapshot->Capture();
+            return new PhysicsUpdateHandle(self, delta_time, collision_steps, temp_allocator, job_system);
+        }, "delta_time"_a, "collision_steps"_a, "temp_allocator"_a, "job_system"_a, "snapshot"_a.none() = nb::none(),
+            nb::rv_policy::take_ownership, nb::keep_alive<0, 1>(), nb::keep_alive<0, 4>(), nb::keep_alive<0, 5>(),
+            "Start simulating the system on a separate thread and return immediately.\n"
+            "Args:\n"
+            "    delta_time (float): Time to simulate.\n"
+            "    collision_steps (int): Number of collision steps.\n"
+            "    temp_allocator (TempAllocator): Allocator used during the update.\n"
+            "    job_system (JobSystem): Job system that runs the jobs of the update.\n"
+            "    snapshot (TransformSnapshot): When set, the transforms are captured into it before the step starts, so they can be read while the step runs.\n"
+            "Returns:\n"
+            "    PhysicsUpdateHandle: Handle to wait on or await. Don't use the physics system (including body interfaces and queries) until the update is done.")
         .def("save_state", &PhysicsSystem::SaveState, "stream"_a, "state"_a = (int)EStateRecorderState::All, "filter"_a = nullptr,
+            nb::call_guard<nb::gil_scoped_release>(),
             "Saving state for replay")
         .def("restore_state", &PhysicsSystem::RestoreState, "stream"_a, "filter"_a = nullptr,
+            nb::call_guard<nb::gil_scoped_release>(),
             "Restoring state for replay. Returns false if failed.")
+        .def("restore_state", [](PhysicsSystem &self, nb::handle data, const StateRecorderFilter *filter) {
+            Py_buffer view;
+            if (PyObject_GetBuffer(data.ptr(), &view, PyBUF_C_CONTIGUOUS) != 0)
+                throw nb::python_error();
+
+            // Read the state in place
+            StateRecorderBuffer recorder;
+            recorder.SetExternalData(view.buf, size_t(view.len));
+            bool result;
+            {
+                nb::gil_scoped_release release;
+                result = self.RestoreState(recorder, filter);
+            }
+            PyBuffer_Release(&view);
+            return result;
+        }, "data"_a, "filter"_a = nullptr,
+            "Restore state from a bytes-like object (e.g. StateRecorderBuffer.get_view() or bytes received from the network) without copying it.\n"
+            "Returns false if failed.")
         .def("save_body_state", &PhysicsSystem::SaveBodyState, "body"_a, "stream"_a,
             "Saving state of a single body.")
         .def("restore_body_state", &PhysicsSystem::RestoreBodyState, "body"_a, "stream"_a,
@@ -126,6 +418,50 @@ void BindPhysicsSystem(nb::module_ &m) {
         }, "Get copy of the list of all bodies under protection of a lock.\n"
             "Returns:\n"
             "    BodyIDVector: On return, this will contain the list of BodyIDs.")
+        .def("read_body_states", [](const PhysicsSystem &self, const NumpyBodyIDs &ids, nb::handle out_positions, nb::handle out_rotations,
+                                    nb::handle out_linear_velocities, nb::handle out_angular_velocities) {
+            return ReadBodyStates(self, ids, ToOutputRows<3>(out_positions, "out_positions"), ToOutputRows<4>(out_rotations, "out_rotations"),
+                                  ToOutputRows<3>(out_linear_velocities, "out_linear_velocities"), ToOutputRows<3>(out_angular_velocities, "out_angular_velocities"));
+        }, "ids"_a, "out_positions"_a.none() = nb::none(), "out_rotations"_a.none() = nb::none(),
+            "out_linear_velocities"_a.none() = nb::none(), "out_angular_velocities"_a.none() = nb::none(),
+            "Bulk read the state of many bodies into caller owned NumPy arrays.\n"
+            "All bodies are locked in a single pass and the GIL is released while copying. Channels that are None are skipped.\n"
+            "Rows of bodies that could not be locked (invalid / removed ID) are filled with NaN. Read-only arrays raise ValueError.\n"
+            "Args:\n"
+            "    ids (numpy.ndarray): (N,) uint32 array of body IDs (BodyID.get_index_and_sequence_number()).\n"
+            "    out_positions (numpy.ndarray): (N, 3) float32 or float64 array that receives the body positions.\n"
+            "    out_rotations (numpy.ndarray): (N, 4) float32 or float64 array that receives the rotations as (x, y, z, w).\n"
+            "    out_linear_velocities (numpy.ndarray): (N, 3) float32 or float64 array that receives the linear velocities.\n"
+            "    out_angular_velocities (numpy.ndarray): (N, 3) float32 or float64 array that receives the angular velocities.\n"
+            "Returns:\n"
+            "    int: Number of bodies that were found.")
+        .def("write_body_states", &WriteBodyStates,
+            "ids"_a, "positions"_a.none() = nb::none(), "rotations"_a.none() = nb::none(),
+            "linear_velocities"_a.none() = nb::none(), "angular_velocities"_a.none() = nb::none(),
+            "activation_mode"_a = EActivation::Activate,
+            "Bulk version of BodyInterface.set_position_rotation_and_velocity, channels that are None are left untouched.\n"
+            "All bodies are locked in a single pass, the broadphase is notified once for all moved bodies and the GIL is released while applying.\n"
+            "Args:\n"
+            "    ids (numpy.ndarray): (N,) uint32 array of body IDs.\n"
+            "    positions (numpy.ndarray): (N, 3) float32 or float64 array of new positions.\n"
+            "    rotations (numpy.ndarray): (N, 4) float32 or float64 array of new rotations as (x, y, z, w).\n"
+            "    linear_velocities (numpy.ndarray): (N, 3) float32 or float64 array of new linear velocities.\n"
+            "    angular_velocities (numpy.ndarray): (N, 3) float32 or float64 array of new angular velocities.\n"
+            "    activation_mode (EActivation): If bodies that are moved should be activated. Non zero velocities always activate the body.\n"
+            "Returns:\n"
+            "    int: Number of bodies that were found.")
+        .def("add_body_forces", [](PhysicsSystem &self, const NumpyBodyIDs &ids, const NumpyRows<3> &forces, const NumpyRows<3> &torques, EActivation activation_mode) {
+            return AddBodyForces(self, ids, forces, torques, activation_mode, false);
+        }, "ids"_a, "forces"_a.none(), "torques"_a.none() = nb::none(), "activation_mode"_a = EActivation::Activate,
+            "Bulk version of BodyInterface.add_force_and_torque, forces and torques are (N, 3) float32 or float64 arrays.\n"
+            "Returns:\n"
+            "    int: Number of dynamic bodies that received a force.")
+        .def("add_body_impulses", [](PhysicsSystem &self, const NumpyBodyIDs &ids, const NumpyRows<3> &impulses, const NumpyRows<3> &angular_impulses) {
+            return AddBodyForces(self, ids, impulses, angular_impulses, EActivation::Activate, true);
+        }, "ids"_a, "impulses"_a.none(), "angular_impulses"_a.none() = nb::none(),
+            "Bulk version of BodyInterface.add_impulse / add_angular_impulse, impulses are (N, 3) float32 or float64 arrays.\n"
+            "Returns:\n"
+            "    int: Number of dynamic bodies that received an impulse.")
         .def("get_active_bodies", &PhysicsSystem::GetActiveBodies, "type"_a, "body_i_ds"_a,
             "Get copy of the list of active bodies under protection of a lock.\n"
             "Args:\n"
@@ -28,9 +28,9 @@ void BindSoftBodySharedSettings(nb::module_ &m) {
             "Calculates the initial volume of all tetrahedra of this soft body")
         .def("calculate_skinned_constraint_normals", &SoftBodySharedSettings::CalculateSkinnedConstraintNormals,
             "Calculate information needed to be able to calculate the skinned constraint normals at run-time")
-        .def("optimize", nb::overload_cast<SoftBodySharedSettings::OptimizationResults &>(&SoftBodySharedSettings::Optimize), "results"_a,
+        .def("optimize", nb::overload_cast<SoftBodySharedSettings::OptimizationResults &>(&SoftBodySharedSettings::Optimize), "results"_a, nb::call_guard<nb::gil_scoped_release>(),
             "Optimize the soft body settings for simulation. This will reorder constraints so they can be executed in parallel.")
-        .def("optimize", nb::overload_cast<>(&SoftBodySharedSettings::Optimize),
+        .def("optimize", nb::overload_cast<>(&SoftBodySharedSettings::Optimize), nb::call_guard<nb::gil_scoped_release>(),
             "Optimize the soft body settings without results")
         .def("clone", &SoftBodySharedSettings::Clone,
             "Clone this object")
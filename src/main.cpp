@@ -166,6 +166,17 @@ NB_MODULE(pyjolt_ext, mainModule) {
     BIND(BindMotionProperties, mainModule);
     BIND(BindMotionQuality, mainModule);
     BIND(BindMotionType, mainModule);
+    BIND(BindBodyChangeFeed, mainModule);
+    BIND(BindAsyncUpdate, mainModule);
+    BIND(BindParallelKernels, mainModule);
+    BIND(BindJobSystemWorkStealing, mainModule);
+    BIND(BindNativeStreams, mainModule);
+    BIND(BindStateRecorderBuffer, mainModule);
+    BIND(BindSnapshotRing, mainModule);
+    BIND(BindDeltaStateRecorder, mainModule);
+    BIND(BindTransformQuantizer, mainModule);
+    BIND(BindShapeCache, mainModule);
+    BIND(BindShapeRegistry, mainModule);
 
     // Character
     BIND(BindCharacterBase, mainModule);
@@ -192,6 +203,8 @@ NB_MODULE(pyjolt_ext, mainModule) {
     BIND(BindCollisionDispatch, mainModule);
     BIND(BindCollisionGroup, mainModule);
     BIND(BindContactListener, mainModule);
+    BIND(BindBufferedContactListener, mainModule);
+    BIND(BindContactRulesListener, mainModule);
     BIND(BindEstimateCollisionResponse, mainModule);
     BIND(BindGroupFilter, mainModule);
     BIND(BindGroupFilterTable, mainModule);
@@ -0,0 +1,135 @@
+"""Round trip of the Array from_numpy / to_numpy bindings and the rules for their views.
+
+- from_numpy(a).to_numpy() equals a for scalar, fixed size and padded Vec3 / DVec3 element types
+- Vec3 / DVec3 accept (N, 3) and (N, 4) input and their views are read-only
+- bad shapes raise ValueError
+- while a view is alive, resizing the array raises BufferError, after the view is released it works again
+- numpy.asarray(array, dtype=..., copy=False) raises ValueError when a copy is needed
+Run from the repository root: python tests/array_numpy_roundtrip.py
+"""
+import gc
+import sys
+
+import numpy as np
+
+import pyjolt
+
+# Array type, dtype, element shape
+ROUND_TRIPS = (
+    (pyjolt.Uint8Array, np.uint8, ()),
+    (pyjolt.Uint32Array, np.uint32, ()),
+    (pyjolt.Int32TArray, np.int32, ()),
+    (pyjolt.FloatArray, np.float32, ()),
+    (pyjolt.DoubleArray, np.float64, ()),
+    (pyjolt.Float3Array, np.float32, (3,)),
+    (pyjolt.Vec4Array, np.float32, (4,)),
+    (pyjolt.Mat44Array, np.float32, (4, 4)),
+)
+PADDED = (
+    (pyjolt.Vec3Array, np.float32),
+    (pyjolt.DVec3Array, np.float64),
+)
+
+
+def sample(rng, dtype, shape):
+    if np.issubdtype(dtype, np.integer):
+        return rng.integers(0, np.iinfo(dtype).max, size=shape, dtype=dtype, endpoint=True)
+    return rng.normal(size=shape).astype(dtype)
+
+
+def main():
+    rng = np.random.default_rng(42)
+    failures = []
+
+    def check(condition, message):
+        if not condition:
+            failures.append(message)
+
+    def check_raises(exception, function, message):
+        try:
+            function()
+        except exception:
+            return
+        except Exception as e:
+            failures.append(f"{message}: raised {type(e).__name__} instead of {exception.__name__}")
+            return
+        failures.append(f"{message}: nothing was raised")
+
+    for array_type, dtype, element_shape in ROUND_TRIPS:
+        name = array_type.__name__
+        for count in (0, 1, 17):
+            data = sample(rng, dtype, (count, *element_shape))
+            array = array_type.from_numpy(data)
+            check(array.size() == count, f"{name}: size {array.size()} != {count}")
+            view = array.to_numpy()
+            check(view.dtype == dtype and view.shape == data.shape, f"{name}: view has dtype {view.dtype} and shape {view.shape}")
+            check(np.array_equal(view, data), f"{name}: round trip of {count} elements differs")
+            check(np.array_equal(np.asarray(array), data), f"{name}: numpy.asarray differs")
+            del view
+        check_raises(ValueError, lambda: array_type.from_numpy(np.zeros((2, *element_shape, 1), dtype=dtype)), f"{name}: extra dimension")
+        if element_shape:
+            check_raises(ValueError, lambda: array_type.from_numpy(np.zeros((2, element_shape[0] + 1, *element_shape[1:]), dtype=dtype)), f"{name}: wrong element shape")
+
+    for array_type, dtype in PADDED:
+        name = array_type.__name__
+        xyz = sample(rng, dtype, (9, 3))
+        for data in (xyz, np.concatenate([xyz, sample(rng, dtype, (9, 1))], axis=1)):
+            array = array_type.from_numpy(data)
+            view = array.to_numpy()
+            check(view.shape == (9, 4), f"{name}: view has shape {view.shape}")
+            check(np.array_equal(view[:, :3], xyz), f"{name}: xyz of a {data.shape[1]} column input differ")
+            check(np.array_equal(view[:, 3], xyz[:, 2]), f"{name}: the 4th component is not equal to the 3rd")
+            check(not view.flags.writeable, f"{name}: view is writable")
+            del view
+        check_raises(ValueError, lambda: array_type.from_numpy(np.zeros((2, 5), dtype=dtype)), f"{name}: 5 columns")
+
+    # Views are exports: the array can't move its memory while one is alive
+    array = pyjolt.FloatArray.from_numpy(np.arange(8, dtype=np.float32))
+    view = array.to_numpy()
+    view[0] = 42.0
+    check(array[0] == 42.0, "to_numpy is not a view on the array data")
+    for operation, function in (("push_back", lambda: array.push_back(1.0)), ("resize", lambda: array.resize(100)),
+                                ("reserve", lambda: array.reserve(1000)), ("clear", lambda: array.clear()),
+                                ("pop_back", lambda: array.pop_back()), ("shrink_to_fit", lambda: array.shrink_to_fit()),
+                                ("insert", lambda: array.insert(0, 1.0)), ("erase", lambda: array.erase(0)),
+                                ("swap", lambda: pyjolt.FloatArray().swap(array))):
+        check_raises(BufferError, function, f"{operation} while a view is alive")
+    check(array.size() == 8 and np.array_equal(view[1:], np.arange(1, 8, dtype=np.float32)), "a refused operation changed the array")
+
+    capsule = array.__dlpack__()
+    del view
+    gc.collect()
+    check_raises(BufferError, lambda: array.push_back(1.0), "push_back while a DLPack capsule is alive")
+    del capsule
+    gc.collect()
+    array.push_back(1.0)
+    check(array.size() == 9, "push_back after all views were released failed")
+
+    # The view keeps the array alive
+    view = pyjolt.DoubleArray.from_numpy(np.arange(4, dtype=np.float64)).to_numpy()
+    gc.collect()
+    check(np.array_equal(view, np.arange(4, dtype=np.float64)), "view outlived its array")
+    del view
+
+    # copy=False must not silently copy, the copy argument of numpy.asarray was added in NumPy 2
+    array = pyjolt.FloatArray.from_numpy(np.arange(4, dtype=np.float32))
+    if np.lib.NumpyVersion(np.__version__) >= "2.0.0":
+        check(not np.asarray(array, dtype=np.float32, copy=False).flags.owndata, "copy=False with the same dtype copied")
+        check_raises(ValueError, lambda: np.asarray(array, dtype=np.float64, copy=False), "copy=False with a different dtype")
+    copy = np.asarray(array, dtype=np.float64)
+    check(copy.dtype == np.float64 and np.array_equal(copy, np.arange(4)), "dtype conversion failed")
+    copy = np.array(array, copy=True)
+    del copy
+    gc.collect()
+    array.push_back(1.0)
+
+    for message in failures:
+        print(f"FAILED: {message}")
+    if failures:
+        return 1
+    print("OK")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
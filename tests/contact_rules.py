@@ -0,0 +1,113 @@
+"""Simulate boxes on separate floor slabs that each have their own ContactRulesListener rules and check the outcome.
+
+- reject: the box falls through its slab
+- conveyor: surface_velocity on the slab carries the box along +X
+- override: of two matching restitution rules the later one wins, the box doesn't bounce
+- bounce: a single restitution rule of 1 makes the box bounce back up
+- control: no rules, the box comes to rest on its slab
+Run from the repository root: python tests/contact_rules.py [--steps N]
+"""
+import argparse
+import os
+import sys
+
+import numpy as np
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "samples"))
+
+import pyjolt
+from pyjolt.math import Vec3, Quat
+from layers import Layers, BPLayerInterfaceImpl, ObjectVsBroadPhaseLayerFilterImpl, ObjectLayerPairFilterImpl
+
+DELTA_TIME = 1.0 / 60.0
+SLAB_SPACING = 20.0
+DROP_HEIGHT = 5.0
+SCENARIOS = ("reject", "conveyor", "override", "bounce", "control")
+
+
+def ids_array(*body_ids):
+    return np.array([body_id.get_index_and_sequence_number() for body_id in body_ids], dtype=np.uint32)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--steps", type=int, default=180)
+    args = parser.parse_args()
+
+    pyjolt.register_default_allocator()
+    pyjolt.new_factory()
+    pyjolt.register_types()
+
+    layers = (BPLayerInterfaceImpl(), ObjectVsBroadPhaseLayerFilterImpl(), ObjectLayerPairFilterImpl())
+    physics_system = pyjolt.PhysicsSystem()
+    physics_system.init(64, 0, 1024, 1024, *layers, num_object_layers=int(Layers.NUM_LAYERS))
+    body_interface = physics_system.get_body_interface()
+
+    slab_shape = pyjolt.BoxShape(Vec3(8.0, 1.0, 8.0), 0.0)
+    box_shape = pyjolt.BoxShape(Vec3(0.5, 0.5, 0.5))
+    slabs, boxes = {}, {}
+    for i, name in enumerate(SCENARIOS):
+        x = i * SLAB_SPACING
+        slabs[name] = body_interface.create_and_add_body(pyjolt.BodyCreationSettings(slab_shape, Vec3(x, -1.0, 0.0), Quat.identity(), pyjolt.EMotionType.STATIC, Layers.NON_MOVING), pyjolt.EActivation.DONT_ACTIVATE)
+        height = DROP_HEIGHT if name in ("override", "bounce") else 0.5
+        boxes[name] = body_interface.create_and_add_body(pyjolt.BodyCreationSettings(box_shape, Vec3(x, height, 0.0), Quat.identity(), pyjolt.EMotionType.DYNAMIC, Layers.MOVING), pyjolt.EActivation.ACTIVATE)
+
+    listener = pyjolt.ContactRulesListener()
+    listener.add_rule(body_ids=ids_array(boxes["reject"]), reject=True)
+    listener.add_rule(body_ids=ids_array(slabs["conveyor"]), surface_velocity=Vec3(2.0, 0.0, 0.0), friction=1.0)
+    listener.add_rule(body_ids=ids_array(slabs["override"]), restitution=1.0)
+    listener.add_rule(body_ids=ids_array(slabs["override"]), restitution=0.0)
+    listener.add_rule(body_ids=ids_array(slabs["bounce"]), restitution=1.0)
+    physics_system.set_contact_listener(listener)
+
+    temp_allocator = pyjolt.TempAllocatorImpl(16 * 1024 * 1024)
+    job_system = pyjolt.JobSystemThreadPool(pyjolt.MAX_PHYSICS_JOBS, pyjolt.MAX_PHYSICS_BARRIERS, 1)
+
+    ids = ids_array(*(boxes[name] for name in SCENARIOS))
+    positions = np.empty((len(SCENARIOS), 3))
+    physics_system.read_body_states(ids, positions)
+    start = positions.copy()
+    landed = np.zeros(len(SCENARIOS), dtype=bool)
+    max_height_after_landing = np.full(len(SCENARIOS), -np.inf)
+    for _ in range(args.steps):
+        physics_system.update(DELTA_TIME, 1, temp_allocator, job_system)
+        physics_system.read_body_states(ids, positions)
+        landed |= positions[:, 1] < 0.75
+        max_height_after_landing = np.where(landed, np.maximum(max_height_after_landing, positions[:, 1]), max_height_after_landing)
+
+    index = {name: i for i, name in enumerate(SCENARIOS)}
+    failures = []
+
+    def check(condition, message):
+        if not condition:
+            failures.append(message)
+
+    check(positions[index["reject"], 1] < -2.0, f"rejected box is at y {positions[index['reject'], 1]:.3f}, it should have fallen through its slab")
+    moved = positions[index["conveyor"], 0] - start[index["conveyor"], 0]
+    check(moved > 1.0, f"conveyor moved the box {moved:.3f} along X, expected more than 1")
+    check(landed[index["override"]] and max_height_after_landing[index["override"]] < 1.0,
+          f"box on the override slab bounced to {max_height_after_landing[index['override']]:.3f}, the later restitution rule should win")
+    check(landed[index["bounce"]] and max_height_after_landing[index["bounce"]] > 0.5 * DROP_HEIGHT,
+          f"box on the bounce slab only bounced to {max_height_after_landing[index['bounce']]:.3f}")
+    control = positions[index["control"]] - start[index["control"]]
+    check(abs(control[1]) < 0.05 and np.hypot(control[0], control[2]) < 0.05, f"control box moved by {control}")
+
+    physics_system.set_contact_listener(None)
+    del job_system, temp_allocator
+    for body_id in physics_system.get_bodies():
+        body_interface.remove_body(body_id)
+        body_interface.destroy_body(body_id)
+    del listener, body_interface, physics_system, layers
+    pyjolt.unregister_types()
+    pyjolt.delete_factory()
+
+    for message in failures:
+        print(f"FAILED: {message}")
+    if failures:
+        return 1
+    print(f"OK: {len(SCENARIOS)} scenarios")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,114 @@
+"""Round trip of DeltaStateRecorder: record a keyframe and a delta per step, then rebuild every step from the keyframe and the deltas.
+
+With zero tolerances the rebuilt body states must be bit identical to the recorded ones. Truncated or oversized deltas must be
+rejected by apply_delta.
+Run from the repository root: python tests/delta_state_roundtrip.py [--steps N]
+"""
+import argparse
+import os
+import struct
+import sys
+
+import numpy as np
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "samples"))
+
+import pyjolt
+from pyjolt.math import Vec3, Quat
+from layers import Layers, BPLayerInterfaceImpl, ObjectVsBroadPhaseLayerFilterImpl, ObjectLayerPairFilterImpl
+
+MAX_BODIES = 1024
+DELTA_TIME = 1.0 / 60.0
+
+
+def read_states(physics_system, ids):
+    states = [np.empty((len(ids), 3)), np.empty((len(ids), 4)), np.empty((len(ids), 3)), np.empty((len(ids), 3))]
+    physics_system.read_body_states(ids, *states)
+    return states
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--steps", type=int, default=60)
+    args = parser.parse_args()
+
+    pyjolt.register_default_allocator()
+    pyjolt.new_factory()
+    pyjolt.register_types()
+
+    layers = (BPLayerInterfaceImpl(), ObjectVsBroadPhaseLayerFilterImpl(), ObjectLayerPairFilterImpl())
+    physics_system = pyjolt.PhysicsSystem()
+    physics_system.init(MAX_BODIES, 0, 4096, 4096, *layers, num_object_layers=int(Layers.NUM_LAYERS))
+    body_interface = physics_system.get_body_interface()
+
+    floor = pyjolt.BodyCreationSettings(pyjolt.BoxShape(Vec3(50.0, 1.0, 50.0), 0.0), Vec3(0.0, -1.0, 0.0), Quat.identity(), pyjolt.EMotionType.STATIC, Layers.NON_MOVING)
+    body_interface.create_and_add_body(floor, pyjolt.EActivation.DONT_ACTIVATE)
+
+    # Stacks that settle at different times, so the deltas contain a changing subset of the bodies
+    box = pyjolt.BoxShape(Vec3(0.5, 0.5, 0.5))
+    for x in range(5):
+        for i in range(2 + 2 * x):
+            settings = pyjolt.BodyCreationSettings(box, Vec3(4.0 * x, 0.5 + 1.1 * i, 0.0), Quat.identity(), pyjolt.EMotionType.DYNAMIC, Layers.MOVING)
+            body_interface.create_and_add_body(settings, pyjolt.EActivation.ACTIVATE)
+    ids = np.array([body_id.get_index_and_sequence_number() for body_id in physics_system.get_bodies()], dtype=np.uint32)
+
+    temp_allocator = pyjolt.TempAllocatorImpl(16 * 1024 * 1024)
+    job_system = pyjolt.JobSystemThreadPool(pyjolt.MAX_PHYSICS_JOBS, pyjolt.MAX_PHYSICS_BARRIERS, 1)
+
+    # Record
+    keyframe = pyjolt.StateRecorderImpl()
+    physics_system.save_state(keyframe)
+    recorder = pyjolt.DeltaStateRecorder(physics_system)
+    recorder.set_base()
+
+    deltas = []
+    expected = []
+    for _ in range(args.steps):
+        physics_system.update(DELTA_TIME, 1, temp_allocator, job_system)
+        stream = pyjolt.StreamOutMemory()
+        recorder.save_delta(stream)
+        deltas.append(stream.to_bytes())
+        expected.append(read_states(physics_system, ids))
+
+    failures = []
+
+    def check(condition, message):
+        if not condition:
+            failures.append(message)
+
+    # Rebuild from the keyframe and compare every step
+    keyframe.rewind()
+    check(physics_system.restore_state(keyframe), "restoring the keyframe failed")
+    for step, (delta, reference) in enumerate(zip(deltas, expected)):
+        if not pyjolt.DeltaStateRecorder.apply_delta(physics_system, delta):
+            failures.append(f"apply_delta failed at step {step}")
+            break
+        for name, actual, wanted in zip(("positions", "rotations", "linear velocities", "angular velocities"), read_states(physics_system, ids), reference):
+            check(np.array_equal(actual, wanted), f"{name} differ at step {step}")
+        if failures:
+            break
+
+    # Damaged deltas must be rejected, the magic and the number of changed bodies are the first two uint32 values
+    check(not pyjolt.DeltaStateRecorder.apply_delta(physics_system, deltas[0][:len(deltas[0]) // 2]), "truncated delta was applied")
+    if len(deltas[0]) >= 8:
+        oversized = deltas[0][:4] + struct.pack("<I", MAX_BODIES + 1) + deltas[0][8:]
+        check(not pyjolt.DeltaStateRecorder.apply_delta(physics_system, oversized), "delta with more bodies than the system can hold was applied")
+
+    del recorder, job_system, temp_allocator
+    for body_id in physics_system.get_bodies():
+        body_interface.remove_body(body_id)
+        body_interface.destroy_body(body_id)
+    del body_interface, physics_system, layers
+    pyjolt.unregister_types()
+    pyjolt.delete_factory()
+
+    for message in failures:
+        print(f"FAILED: {message}")
+    if failures:
+        return 1
+    print(f"OK: {len(deltas)} deltas, {sum(len(delta) for delta in deltas)} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
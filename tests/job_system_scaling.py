@@ -0,0 +1,120 @@
+"""Compare JobSystemThreadPool and JobSystemWorkStealing on pyramid and stack scenes at 1 to 64 threads.
+
+Every scene is simulated from the same initial state for each job system and thread count, the average time of
+PhysicsSystem.update is reported. Thread counts above the number of cores are included on purpose, oversubscription
+is where the two job systems differ most.
+Run from the repository root: python tests/job_system_scaling.py [--steps N] [--threads 1,2,4,...]
+"""
+import argparse
+import os
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "samples"))
+
+import pyjolt
+from pyjolt.math import Vec3, Quat
+from layers import Layers, BPLayerInterfaceImpl, ObjectVsBroadPhaseLayerFilterImpl, ObjectLayerPairFilterImpl
+
+MAX_BODIES = 65_536
+MAX_BODY_PAIRS = 65_536
+MAX_CONTACT_CONSTRAINTS = 65_536
+TEMP_ALLOCATOR_SIZE = 64 * 1024 * 1024
+DELTA_TIME = 1.0 / 60.0
+BOX_HALF_EXTENT = 0.5
+
+
+def add_floor(body_interface, size):
+    floor = pyjolt.BodyCreationSettings(pyjolt.BoxShape(Vec3(0.5 * size, 1.0, 0.5 * size), 0.0), Vec3(0.0, -1.0, 0.0), Quat.identity(), pyjolt.EMotionType.STATIC, Layers.NON_MOVING)
+    body_interface.create_and_add_body(floor, pyjolt.EActivation.DONT_ACTIVATE)
+
+
+def build_pyramids(body_interface, box):
+    # 4 x 4 pyramids with 15 layers each, every pyramid is one large island
+    size = 15
+    for px in range(4):
+        for pz in range(4):
+            origin_x, origin_z = (px - 1.5) * 40.0, (pz - 1.5) * 40.0
+            for layer in range(size):
+                for j in range(layer, size):
+                    for k in range(layer, size):
+                        position = Vec3(origin_x - size + 2.0 * j + layer, 1.0 + 2.0 * layer, origin_z - size + 2.0 * k + layer)
+                        settings = pyjolt.BodyCreationSettings(box, position, Quat.identity(), pyjolt.EMotionType.DYNAMIC, Layers.MOVING)
+                        body_interface.create_and_add_body(settings, pyjolt.EActivation.ACTIVATE)
+
+
+def build_stacks(body_interface, box):
+    # 20 x 20 stacks of 10 boxes, many small islands
+    for x in range(20):
+        for z in range(20):
+            for i in range(10):
+                position = Vec3((x - 9.5) * 4.0, 1.0 + 2.0 * i, (z - 9.5) * 4.0)
+                settings = pyjolt.BodyCreationSettings(box, position, Quat.identity(), pyjolt.EMotionType.DYNAMIC, Layers.MOVING)
+                body_interface.create_and_add_body(settings, pyjolt.EActivation.ACTIVATE)
+
+
+SCENES = {
+    "pyramid": build_pyramids,
+    "stack": build_stacks,
+}
+
+
+def simulate(build_scene, job_system, num_steps):
+    layers = (BPLayerInterfaceImpl(), ObjectVsBroadPhaseLayerFilterImpl(), ObjectLayerPairFilterImpl())
+    physics_system = pyjolt.PhysicsSystem()
+    physics_system.init(MAX_BODIES, 0, MAX_BODY_PAIRS, MAX_CONTACT_CONSTRAINTS, *layers, num_object_layers=int(Layers.NUM_LAYERS))
+
+    body_interface = physics_system.get_body_interface()
+    add_floor(body_interface, 400.0)
+    build_scene(body_interface, pyjolt.BoxShape(Vec3(BOX_HALF_EXTENT, BOX_HALF_EXTENT, BOX_HALF_EXTENT)))
+    physics_system.optimize_broad_phase()
+
+    temp_allocator = pyjolt.TempAllocatorImpl(TEMP_ALLOCATOR_SIZE)
+    start = time.perf_counter()
+    for _ in range(num_steps):
+        physics_system.update(DELTA_TIME, 1, temp_allocator, job_system)
+    elapsed = time.perf_counter() - start
+
+    for body_id in physics_system.get_bodies():
+        body_interface.remove_body(body_id)
+        body_interface.destroy_body(body_id)
+    return 1000.0 * elapsed / num_steps
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--steps", type=int, default=300)
+    parser.add_argument("--threads", type=str, default="1,2,4,8,16,32,64", help="Comma separated number of worker threads")
+    parser.add_argument("--scenes", type=str, default=",".join(SCENES), help="Comma separated scenes: " + ", ".join(SCENES))
+    args = parser.parse_args()
+
+    thread_counts = [int(t) for t in args.threads.split(",")]
+    scenes = args.scenes.split(",")
+
+    pyjolt.register_default_allocator()
+    pyjolt.new_factory()
+    pyjolt.register_types()
+
+    job_systems = {
+        "thread_pool": lambda num_threads: pyjolt.JobSystemThreadPool(pyjolt.MAX_PHYSICS_JOBS, pyjolt.MAX_PHYSICS_BARRIERS, num_threads),
+        "work_stealing": lambda num_threads: pyjolt.JobSystemWorkStealing(pyjolt.MAX_PHYSICS_JOBS, pyjolt.MAX_PHYSICS_BARRIERS, num_threads),
+    }
+
+    print(f"{'scene':>8} {'threads':>8} " + " ".join(f"{name + ' ms':>17}" for name in job_systems) + f" {'speedup':>8}")
+    for scene in scenes:
+        for num_threads in thread_counts:
+            times = {}
+            for name, create_job_system in job_systems.items():
+                job_system = create_job_system(num_threads)
+                times[name] = simulate(SCENES[scene], job_system, args.steps)
+                del job_system
+            speedup = times["thread_pool"] / times["work_stealing"]
+            print(f"{scene:>8} {num_threads:>8} " + " ".join(f"{times[name]:>17.3f}" for name in job_systems) + f" {speedup:>8.2f}")
+
+    pyjolt.unregister_types()
+    pyjolt.delete_factory()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
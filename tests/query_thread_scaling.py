@@ -0,0 +1,122 @@
+"""Throughput of NarrowPhaseQuery.cast_ray from 1 to N Python threads.
+
+The query bindings release the GIL while the broadphase and the shapes are traversed, so with native filters and
+collectors the throughput should grow with the number of threads (on free-threaded CPython the Python side scales too).
+Run from the repository root: python tests/query_thread_scaling.py [--max-threads N] [--duration SECONDS]
+"""
+import argparse
+import os
+import sys
+import threading
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "samples"))
+
+import pyjolt
+from pyjolt.math import Vec3, Quat
+from layers import Layers, BPLayerInterfaceImpl, ObjectVsBroadPhaseLayerFilterImpl, ObjectLayerPairFilterImpl
+
+GRID_SIZE = 24          # GRID_SIZE^3 spheres
+SPACING = 2.0
+RAYS_PER_CALL_BATCH = 64
+
+
+def create_world():
+    broad_phase_layer_interface = BPLayerInterfaceImpl()
+    object_vs_broad_phase_layer_filter = ObjectVsBroadPhaseLayerFilterImpl()
+    object_layer_pair_filter = ObjectLayerPairFilterImpl()
+
+    physics_system = pyjolt.PhysicsSystem()
+    physics_system.init(GRID_SIZE ** 3, 0, 1024, 1024,
+                        broad_phase_layer_interface, object_vs_broad_phase_layer_filter, object_layer_pair_filter,
+                        num_object_layers=int(Layers.NUM_LAYERS))
+
+    body_interface = physics_system.get_body_interface()
+    sphere = pyjolt.SphereShape(0.5)
+    for x in range(GRID_SIZE):
+        for y in range(GRID_SIZE):
+            for z in range(GRID_SIZE):
+                settings = pyjolt.BodyCreationSettings(sphere, Vec3(x * SPACING, y * SPACING, z * SPACING), Quat.identity(), pyjolt.EMotionType.STATIC, Layers.NON_MOVING)
+                body_interface.create_and_add_body(settings, pyjolt.EActivation.DONT_ACTIVATE)
+    physics_system.optimize_broad_phase()
+
+    # Keep the layer objects alive together with the system
+    return physics_system, (broad_phase_layer_interface, object_vs_broad_phase_layer_filter, object_layer_pair_filter)
+
+
+def worker(query, seed, stop, counts, index):
+    # Native filters and collectors, nothing calls back into Python during the traversal
+    settings = pyjolt.RayCastSettings()
+    broad_phase_layer_filter = pyjolt.BroadPhaseLayerFilter()
+    object_layer_filter = pyjolt.ObjectLayerFilter()
+    body_filter = pyjolt.BodyFilter()
+    shape_filter = pyjolt.ShapeFilter()
+    collector = pyjolt.AllHitCollisionCollector_CastRayCollector()
+
+    extent = GRID_SIZE * SPACING
+    rays = []
+    for i in range(RAYS_PER_CALL_BATCH):
+        u = ((seed * 7919 + i * 104729) % 1000) / 1000.0 * extent
+        v = ((seed * 6271 + i * 15485863) % 1000) / 1000.0 * extent
+        rays.append(pyjolt.RRayCast(Vec3(-1.0, u, v), Vec3(extent + 2.0, 0.1 * u, -0.1 * v)))
+
+    num_rays = 0
+    while not stop.is_set():
+        for ray in rays:
+            collector.reset()
+            query.cast_ray(ray, settings, collector, broad_phase_layer_filter, object_layer_filter, body_filter, shape_filter)
+        num_rays += len(rays)
+    counts[index] = num_rays
+
+
+def measure(query, num_threads, duration):
+    stop = threading.Event()
+    counts = [0] * num_threads
+    threads = [threading.Thread(target=worker, args=(query, i + 1, stop, counts, i)) for i in range(num_threads)]
+    for thread in threads:
+        thread.start()
+    time.sleep(duration)
+    stop.set()
+    for thread in threads:
+        thread.join()
+    return sum(counts) / duration
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--max-threads", type=int, default=min(os.cpu_count() or 1, 8))
+    parser.add_argument("--duration", type=float, default=2.0)
+    parser.add_argument("--min-speedup", type=float, default=1.3, help="Required speedup of 2 threads over 1 thread (only checked with 2+ cores)")
+    args = parser.parse_args()
+
+    pyjolt.register_default_allocator()
+    pyjolt.new_factory()
+    pyjolt.register_types()
+
+    physics_system, layers = create_world()
+    query = physics_system.get_narrow_phase_query()
+
+    thread_counts = [1]
+    while thread_counts[-1] * 2 <= args.max_threads:
+        thread_counts.append(thread_counts[-1] * 2)
+    if thread_counts[-1] != args.max_threads:
+        thread_counts.append(args.max_threads)
+
+    print(f"{'threads':>8} {'rays/s':>12} {'speedup':>8}")
+    results = {}
+    for num_threads in thread_counts:
+        results[num_threads] = measure(query, num_threads, args.duration)
+        print(f"{num_threads:>8} {results[num_threads]:>12.0f} {results[num_threads] / results[1]:>8.2f}")
+
+    del query, physics_system, layers
+    pyjolt.unregister_types()
+    pyjolt.delete_factory()
+
+    if (os.cpu_count() or 1) >= 2 and 2 in results and results[2] / results[1] < args.min_speedup:
+        print(f"FAILED: 2 threads are only {results[2] / results[1]:.2f}x faster than 1 thread, expected at least {args.min_speedup}x")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -83,7 +83,7 @@ class ObjectVsBroadPhaseLayerFilterImpl(pyjolt.ObjectVsBroadPhaseLayerFilter):
             return layer_type == BroadPhaseLayers.NON_MOVING
         elif layer_1 == Layers.SENSOR:
             return layer_type == BroadPhaseLayers.MOVING
-        elif layer_1 in (Layers.UNUSED1, Layers.UNUSED2, Layers.UNUSED3):
+        elif layer_1 in (Layers.UNUSED1, Layers.UNUSED2, Layers.UNUSED3, Layers.UNUSED4):
             return False
         else:
             assert False, "Invalid object layer"
@@ -0,0 +1,127 @@
+"""Round trip of TransformQuantizer.encode / decode / apply against the error bounds of the record format.
+
+Positions must be within half a quantization step (cell_size / 65535 / 2) plus the float precision of the body position,
+rotations within the angle error of the 10 bit smallest three encoding and velocities within half float precision.
+Run from the repository root: python tests/transform_quantizer_roundtrip.py [--bodies N] [--cell-size SIZE]
+"""
+import argparse
+import os
+import sys
+
+import numpy as np
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "samples"))
+
+import pyjolt
+from pyjolt.math import Vec3, Quat
+from layers import Layers, BPLayerInterfaceImpl, ObjectVsBroadPhaseLayerFilterImpl, ObjectLayerPairFilterImpl
+
+POSITION_RANGE = 5000.0
+LINEAR_VELOCITY_RANGE = 50.0
+ANGULAR_VELOCITY_RANGE = 10.0
+MAX_ROTATION_ERROR = 0.005      # Radians, 10 bits per component gives a step of 2 / sqrt(2) / 1023
+HALF_FLOAT_EPSILON = 2.0 ** -11
+INVALID_BODY_ID = 0xFFFFFFFF
+
+
+def rotation_angles(q1, q2):
+    dots = np.clip(np.abs(np.sum(q1 * q2, axis=1)), 0.0, 1.0)
+    return 2.0 * np.arccos(dots)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--bodies", type=int, default=1000)
+    parser.add_argument("--cell-size", type=float, default=64.0)
+    args = parser.parse_args()
+
+    pyjolt.register_default_allocator()
+    pyjolt.new_factory()
+    pyjolt.register_types()
+
+    layers = (BPLayerInterfaceImpl(), ObjectVsBroadPhaseLayerFilterImpl(), ObjectLayerPairFilterImpl())
+    physics_system = pyjolt.PhysicsSystem()
+    physics_system.init(args.bodies + 1, 0, 1024, 1024, *layers, num_object_layers=int(Layers.NUM_LAYERS))
+    body_interface = physics_system.get_body_interface()
+
+    box = pyjolt.BoxShape(Vec3(0.5, 0.5, 0.5))
+    body_ids = []
+    for _ in range(args.bodies):
+        settings = pyjolt.BodyCreationSettings(box, Vec3(0.0, 0.0, 0.0), Quat.identity(), pyjolt.EMotionType.DYNAMIC, Layers.MOVING)
+        body_ids.append(body_interface.create_and_add_body(settings, pyjolt.EActivation.DONT_ACTIVATE))
+    ids = np.array([body_id.get_index_and_sequence_number() for body_id in body_ids], dtype=np.uint32)
+
+    # A body that was destroyed must get an invalid ID in its record
+    removed = body_interface.create_and_add_body(pyjolt.BodyCreationSettings(box, Vec3(0.0, 0.0, 0.0), Quat.identity(), pyjolt.EMotionType.DYNAMIC, Layers.MOVING), pyjolt.EActivation.DONT_ACTIVATE)
+    removed_id = removed.get_index_and_sequence_number()
+    body_interface.remove_body(removed)
+    body_interface.destroy_body(removed)
+
+    rng = np.random.default_rng(1234)
+    rotations = rng.normal(size=(args.bodies, 4))
+    rotations /= np.linalg.norm(rotations, axis=1, keepdims=True)
+    physics_system.write_body_states(ids,
+                                     positions=rng.uniform(-POSITION_RANGE, POSITION_RANGE, size=(args.bodies, 3)),
+                                     rotations=rotations,
+                                     linear_velocities=rng.uniform(-LINEAR_VELOCITY_RANGE, LINEAR_VELOCITY_RANGE, size=(args.bodies, 3)),
+                                     angular_velocities=rng.uniform(-ANGULAR_VELOCITY_RANGE, ANGULAR_VELOCITY_RANGE, size=(args.bodies, 3)),
+                                     activation_mode=pyjolt.EActivation.DONT_ACTIVATE)
+
+    # Reference state as stored in the bodies
+    positions = np.empty((args.bodies, 3), dtype=np.float64)
+    rotations = np.empty((args.bodies, 4), dtype=np.float64)
+    linear_velocities = np.empty((args.bodies, 3), dtype=np.float64)
+    angular_velocities = np.empty((args.bodies, 3), dtype=np.float64)
+    physics_system.read_body_states(ids, positions, rotations, linear_velocities, angular_velocities)
+
+    quantizer = pyjolt.TransformQuantizer(args.cell_size)
+    packed = quantizer.encode(physics_system, np.append(ids, np.uint32(removed_id)))
+    decoded = quantizer.decode(packed.tobytes())
+
+    failures = []
+
+    def check(condition, message):
+        if not condition:
+            failures.append(message)
+
+    check(packed.shape == (args.bodies + 1, pyjolt.TransformQuantizer.RECORD_SIZE), f"encode returned shape {packed.shape}")
+    check(np.array_equal(decoded["body_ids"][:-1], ids), "decoded body IDs differ")
+    check(decoded["body_ids"][-1] == INVALID_BODY_ID, "destroyed body did not get an invalid ID")
+
+    position_bound = 0.5 * args.cell_size / 65535.0 + 1.0e-6 * np.abs(positions) + 1.0e-6
+    position_error = np.abs(decoded["positions"][:-1] - positions)
+    check(np.all(position_error <= position_bound), f"position error {position_error.max():.6g} exceeds the bound")
+
+    rotation_error = rotation_angles(decoded["rotations"][:-1].astype(np.float64), rotations)
+    check(np.all(rotation_error <= MAX_ROTATION_ERROR), f"rotation error {rotation_error.max():.6g} rad exceeds {MAX_ROTATION_ERROR}")
+
+    for name, reference in (("linear_velocities", linear_velocities), ("angular_velocities", angular_velocities)):
+        error = np.abs(decoded[name][:-1] - reference)
+        check(np.all(error <= HALF_FLOAT_EPSILON * np.abs(reference) + 1.0e-6), f"{name} error {error.max():.6g} exceeds half float precision")
+
+    # Applying the records must give the decoded state, the invalid record is skipped
+    num_applied = quantizer.apply(body_interface, packed)
+    check(num_applied == args.bodies, f"apply updated {num_applied} bodies, expected {args.bodies}")
+    physics_system.read_body_states(ids, positions, rotations, linear_velocities, angular_velocities)
+    check(np.allclose(positions, decoded["positions"][:-1], rtol=1.0e-6, atol=1.0e-6), "applied positions differ from the decoded positions")
+    check(np.all(rotation_angles(rotations, decoded["rotations"][:-1].astype(np.float64)) <= 1.0e-3), "applied rotations differ from the decoded rotations")
+    check(np.allclose(linear_velocities, decoded["linear_velocities"][:-1], rtol=1.0e-6, atol=1.0e-6), "applied linear velocities differ")
+    check(np.allclose(angular_velocities, decoded["angular_velocities"][:-1], rtol=1.0e-6, atol=1.0e-6), "applied angular velocities differ")
+
+    for body_id in body_ids:
+        body_interface.remove_body(body_id)
+        body_interface.destroy_body(body_id)
+    del body_interface, physics_system, layers
+    pyjolt.unregister_types()
+    pyjolt.delete_factory()
+
+    for message in failures:
+        print(f"FAILED: {message}")
+    if failures:
+        return 1
+    print(f"OK: {args.bodies} bodies, max position error {position_error.max():.3g}, max rotation error {rotation_error.max():.3g} rad")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())